@@ -0,0 +1,22 @@
+/*
+ *	host/avr/interrupt.h - stand-in for <avr/interrupt.h>
+ *
+ *	an ISR is just a function (see TIMER1_OVF_vect in host/avr/io.h), and it is only
+ *	ever called between statements of the main code, so sei() and cli() do nothing.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#define ISR(vector, ...)	void vector(void)
+
+#define sei()
+#define cli()
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ *	host/avr/io.h - stand-in for <avr/io.h>, for building miggl on the host (see hostsim.h)
+ *
+ *	the atmega168 registers that miggl uses are plain variables here (see hostsim.c),
+ *	so a host program can look at OCR1A, Disp[], etc after each tick.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define _BV(bit)	(1 << (bit))
+
+// PINB, DDRB, PORTB, PINC, ... PORTD, in that order (as at 0x23 to 0x2b on the AVR)
+extern volatile uint8_t HostPorts[9];
+
+#define PINB	HostPorts[0]
+#define DDRB	HostPorts[1]
+#define PORTB	HostPorts[2]
+#define PINC	HostPorts[3]
+#define DDRC	HostPorts[4]
+#define PORTC	HostPorts[5]
+#define PIND	HostPorts[6]
+#define DDRD	HostPorts[7]
+#define PORTD	HostPorts[8]
+
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t ICR1, OCR1A;
+extern volatile uint8_t UCSR0B;
+
+// port pins
+#define PB0		0
+#define PB1		1
+#define PB2		2
+#define PB3		3
+#define PB4		4
+#define PB5		5
+#define PC0		0
+#define PC1		1
+#define PC2		2
+#define PC3		3
+#define PC4		4
+#define PC5		5
+#define PD0		0
+#define PD1		1
+#define PD2		2
+#define PD3		3
+#define PD4		4
+#define PD5		5
+#define PD6		6
+#define PD7		7
+
+// timer 1 and usart bits
+#define WGM11	1
+#define COM1A1	7
+#define CS11	1
+#define WGM12	3
+#define WGM13	4
+#define TOIE1	0
+#define TXEN0	3
+
+// the timer 1 overflow ISR is a plain function, called once per tick by host_tick()
+#define TIMER1_OVF_vect		host_timer1_ovf
+void host_timer1_ovf(void);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ *	host/avr/pgmspace.h - stand-in for <avr/pgmspace.h> (there is just one memory on the host)
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(addr)		(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t *)(addr))
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ *	hostsim.c - the AVR side of the host build of miggl (see hostsim.h)
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include <util/delay.h>
+
+#include "hostsim.h"
+
+
+// registers (see host/avr/io.h)
+volatile uint8_t HostPorts[9];
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t ICR1, OCR1A;
+volatile uint8_t UCSR0B;
+
+uint32_t HostTicks;
+void (*HostTickHook)(void);
+
+static double DelayUs;		// part of a tick left over from the last delay
+
+
+void host_tick(void)
+{
+	host_timer1_ovf();
+	HostTicks++;
+	if (HostTickHook != NULL) {
+		HostTickHook();
+	}
+}
+
+
+void host_run(uint32_t nticks)
+{
+	while (nticks--) {
+		host_tick();
+	}
+}
+
+
+uint8_t host_speaker(void)
+{
+	return (TCCR1A & _BV(COM1A1)) ? OCR1A : 0;
+}
+
+
+//
+// _delay_us() and _delay_ms() - the ISR keeps running while the main code waits
+//
+void host_delay_us(double us)
+{
+	DelayUs += us;
+	while (DelayUs >= 1000000.0 / HOST_TICK_HZ) {
+		DelayUs -= 1000000.0 / HOST_TICK_HZ;
+		host_tick();
+	}
+}
+
+
+//
+// miggl calls this in its wait loops (see IDLE() in miggl-private.h).  on the AVR the ISR
+// ends the wait, so here we run it.
+//
+void host_idle(void)
+{
+	host_tick();
+}
+
+
+static void wav_put16(FILE *f, uint16_t v)
+{
+	fputc(v & 0xff, f);
+	fputc(v >> 8, f);
+}
+
+static void wav_put32(FILE *f, uint32_t v)
+{
+	wav_put16(f, v & 0xffff);
+	wav_put16(f, v >> 16);
+}
+
+static void wav_header(FILE *f, uint32_t n)
+{
+	fwrite("RIFF", 1, 4, f);
+	wav_put32(f, 36 + n + (n & 1));
+	fwrite("WAVEfmt ", 1, 8, f);
+	wav_put32(f, 16);
+	wav_put16(f, 1);				// PCM
+	wav_put16(f, 1);				// mono
+	wav_put32(f, HOST_TICK_HZ);		// sample rate
+	wav_put32(f, HOST_TICK_HZ);		// bytes per second
+	wav_put16(f, 1);				// block align
+	wav_put16(f, 8);				// bits per sample
+	fwrite("data", 1, 4, f);
+	wav_put32(f, n);
+}
+
+
+//
+// the header is written with no samples, and filled in by host_wavclose(),
+// so samples can be streamed to the file for as long as needed.
+//
+FILE *host_wavopen(const char *name)
+{
+	FILE *f;
+
+	f = fopen(name, "wb");
+	if (f == NULL) {
+		perror(name);
+		return NULL;
+	}
+	wav_header(f, 0);
+	return f;
+}
+
+
+//
+// the PWM value (0 to ICR1) is scaled up to 0 to 255
+//
+void host_wavput(FILE *f, uint8_t val)
+{
+	fputc(val * 255 / (ICR1 + 1), f);
+}
+
+
+int host_wavclose(FILE *f)
+{
+	long n;
+
+	n = ftell(f) - 44;
+	if (n & 1) {
+		fputc(0, f);				// pad byte
+	}
+	if ((n < 0) || (fseek(f, 0, SEEK_SET) != 0)) {
+		fclose(f);
+		return 1;
+	}
+	wav_header(f, n);
+	return (fclose(f) != 0);
+}
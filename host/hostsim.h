@@ -0,0 +1,32 @@
+/*
+ *	hostsim.h - running miggl on the host (Linux, etc) instead of the AVR
+ *
+ *	the host build compiles miggl.c unchanged against the stand-in headers in host/avr
+ *	and host/util.  time only passes when the host program says so: host_tick() runs the
+ *	timer ISR once, which is one tick (1/AUDIO_RATE sec, e.g. 50us) of the real thing.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+// timer ISR rate (see AUDIO_RATE in miggl-private.h - the Makefile passes it to every build)
+#ifndef AUDIO_RATE
+#define AUDIO_RATE		20000UL
+#endif
+#define HOST_TICK_HZ	((int)AUDIO_RATE)
+
+extern uint32_t HostTicks;				// ticks run so far
+extern void (*HostTickHook)(void);		// if set, called after every tick
+
+void host_tick(void);					// run the timer ISR once
+void host_run(uint32_t nticks);			// run it nticks times
+uint8_t host_speaker(void);				// PWM value on the speaker pin (0 if it is off)
+void host_idle(void);					// called by miggl while it waits (e.g. in swapbuffers())
+
+// WAV files of speaker values (8 bit mono, HOST_TICK_HZ)
+FILE *host_wavopen(const char *name);
+void host_wavput(FILE *f, uint8_t val);	// val is a speaker value (see host_speaker())
+int host_wavclose(FILE *f);				// returns 0 if ok
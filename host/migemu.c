@@ -0,0 +1,529 @@
+/*
+ *	migemu.c - runs a Mignonette game in a terminal (Linux, etc), using the host build of miggl
+ *
+ *	the game is compiled for the host with its main() renamed to game_main() (see "make emu"
+ *	in the Makefile), and runs as it would on the AVR.  everything else happens between
+ *	ticks of the timer ISR (see HostTickHook in hostsim.h): once per display cycle (10ms) we
+ *	wait for real time to catch up, read the keyboard, and draw Disp[] with ANSI colors.
+ *
+ *	usage:
+ *		migemu [-x speed] [-t seconds] [-w file.wav] [-p] [-n] [-r file.log | -R file.log]
+ *
+ *		-x speed		run speed times faster than real time (0 is as fast as possible)
+ *		-t seconds		stop after this many seconds (of game time)
+ *		-w file.wav		write the audio to a WAV file
+ *		-p				play the audio (through aplay, at real time only)
+ *		-n				no display (e.g. with -x 0 and -t, for long runs)
+ *		-r file.log		record the buttons, and a hash of the display, for each display cycle
+ *		-R file.log		replay a recording (see setreplay() in miggl.c), checking that every
+ *						display cycle looks the same.  stops at the end of the recording, and
+ *						says how long it took (use -x 0 -n to time the game).
+ *
+ *	a recording is a text file, with a line for each display cycle where the buttons or the
+ *	display changed:  cycle (from 0), buttons (getbuttonmask(), in hex), framehash() (in hex),
+ *	and an "end" line with the number of cycles.  tools/replayc turns it into a table for
+ *	setreplay() on the Mignonette itself.
+ *
+ *	keys:
+ *		a s d f (or 1 2 3 4)	press buttons A B C D for a moment
+ *		A S D F					hold buttons A B C D down (press again to let go)
+ *		q (or ctrl-c)			quit
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <avr/io.h>
+
+#include "mydefs.h"
+#include "miggl.h"
+#include "hostsim.h"
+
+
+#define CYCLE_TICKS		(HOST_TICK_HZ/100)	// ticks in one display cycle (10 rows of 1ms)
+#define PRESS_MS		150					// how long a key press holds a button down
+#define DRAW_MS			20					// shortest time between redraws (real time)
+#define AUDIO_BUF		(HOST_TICK_HZ/50)	// samples written to aplay at a time
+#define MAX_LINE		128
+
+#define BUTTON_PINS		(_BV(PC1) | _BV(PC2) | _BV(PC3) | _BV(PC4))	// SW1-SW4 (see poll_switches())
+
+int game_main(void);
+
+static double Speed = 1.0;
+static double StopTime;				// seconds of game time (0 runs forever)
+static uint8_t NoDisplay;
+static FILE *WavFile;
+static FILE *Player;
+
+static double StartTime;			// real time when the game started
+static double LastDraw;
+static uint8_t LastDisp[10];
+static uint8_t Drawn;
+
+static uint32_t PressTicks[4];		// ticks each button stays down for (from a key press)
+static uint8_t Held;				// buttons held down with A S D F
+
+static uint8_t AudioBuf[AUDIO_BUF];
+static uint16_t AudioCount;
+
+static FILE *RecFile;				// recording (-r)
+static uint8_t RecMask;
+static uint16_t RecHash;
+
+struct replayline {
+	uint32_t cycle;
+	uint8_t mask;
+	uint16_t hash;
+};
+static struct replayline *Replay;	// the recording being replayed (-R)
+static uint32_t ReplayLines;
+static uint32_t ReplayEnd;			// cycles in the recording
+static uint32_t ReplayLine;			// line for the current cycle
+static byte *ReplayTable;			// (see setreplay())
+
+static uint32_t Cycles;				// display cycles so far
+
+static struct termios SavedTerm;
+static uint8_t RawTerm;
+static volatile sig_atomic_t Quit;
+
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void sleep_until(double t)
+{
+	struct timespec ts;
+	double dt;
+
+	dt = t - now();
+	if (dt > 0) {
+		ts.tv_sec = (time_t)dt;
+		ts.tv_nsec = (long)((dt - ts.tv_sec) * 1e9);
+		nanosleep(&ts, NULL);
+	}
+}
+
+
+//
+// terminal
+//
+
+static void term_restore(void)
+{
+	if (RawTerm) {
+		tcsetattr(0, TCSANOW, &SavedTerm);
+		printf("\033[0m\033[?25h\n");		// normal colors, show cursor
+		fflush(stdout);
+		RawTerm = 0;
+	}
+}
+
+
+static void term_raw(void)
+{
+	struct termios t;
+
+	if (!isatty(0) || (tcgetattr(0, &SavedTerm) != 0)) {
+		return;
+	}
+	t = SavedTerm;
+	t.c_lflag &= ~(ICANON | ECHO);		// (leave ISIG on, so ctrl-c works)
+	t.c_cc[VMIN] = 0;
+	t.c_cc[VTIME] = 0;
+	tcsetattr(0, TCSANOW, &t);
+	RawTerm = 1;
+	printf("\033[2J\033[?25l");			// clear screen, hide cursor
+}
+
+
+static void onsignal(int sig)
+{
+	(void)sig;
+	Quit = 1;
+}
+
+
+static void finish(void)
+{
+	term_restore();
+	if (RecFile != NULL) {
+		fprintf(RecFile, "end %lu\n", (unsigned long)Cycles);
+		fclose(RecFile);
+		RecFile = NULL;
+	}
+	if (WavFile != NULL) {
+		host_wavclose(WavFile);
+		WavFile = NULL;
+	}
+	if (Player != NULL) {
+		pclose(Player);
+		Player = NULL;
+	}
+}
+
+
+//
+// keys and buttons
+//
+
+static void readkeys(void)
+{
+	static const char Keys[] = "asdf1234ASDF";
+	const char *k;
+	char buf[32];
+	int i, n, b;
+
+	if (!RawTerm) {
+		return;
+	}
+	n = read(0, buf, sizeof(buf));
+	for (i = 0; i < n; i++) {
+		if ((buf[i] == 'q') || (buf[i] == 'Q')) {
+			Quit = 1;
+		}
+		k = (buf[i] != '\0') ? strchr(Keys, buf[i]) : NULL;
+		if (k == NULL) {
+			continue;
+		}
+		b = k - Keys;
+		if (b < 8) {
+			PressTicks[b & 3] = PRESS_MS * (HOST_TICK_HZ/1000);
+		} else {
+			Held ^= 1 << (b & 3);
+		}
+	}
+}
+
+
+//
+// the switches read high while pressed, on PC1-PC4 (see poll_switches() in miggl.c)
+//
+static void setbuttons(void)
+{
+	uint8_t i, pins;
+
+	pins = 0;
+	for (i = 0; i < 4; i++) {
+		if (PressTicks[i] || (Held & (1 << i))) {
+			pins |= _BV(PC1) << i;
+		}
+	}
+	PINC = (PINC & ~BUTTON_PINS) | pins;
+}
+
+
+//
+// recording and replaying
+//
+
+static void record(void)
+{
+	uint8_t mask;
+	uint16_t hash;
+
+	mask = getbuttonmask();
+	hash = framehash();
+	if ((Cycles == 0) || (mask != RecMask) || (hash != RecHash)) {
+		fprintf(RecFile, "%lu %x %04x\n", (unsigned long)Cycles, mask, hash);
+		RecMask = mask;
+		RecHash = hash;
+	}
+}
+
+
+static int readreplay(const char *name)
+{
+	char line[MAX_LINE];
+	unsigned long cycle, end;
+	unsigned mask, hash;
+	FILE *f;
+
+	f = fopen(name, "r");
+	if (f == NULL) {
+		perror(name);
+		return 1;
+	}
+	end = 0;
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if ((line[0] == '#') || (line[0] == '\n')) {
+			continue;
+		}
+		if (sscanf(line, "end %lu", &end) == 1) {
+			break;
+		}
+		if ((sscanf(line, "%lu %x %x", &cycle, &mask, &hash) != 3)
+			|| ((ReplayLines == 0) ? (cycle != 0) : (cycle <= Replay[ReplayLines-1].cycle))) {
+			fprintf(stderr, "%s: bad line: %s", name, line);
+			fclose(f);
+			return 1;
+		}
+		Replay = realloc(Replay, (ReplayLines + 1) * sizeof(*Replay));
+		if (Replay == NULL) {
+			fprintf(stderr, "migemu: out of memory\n");
+			exit(1);
+		}
+		Replay[ReplayLines].cycle = cycle;
+		Replay[ReplayLines].mask = mask;
+		Replay[ReplayLines].hash = hash;
+		ReplayLines++;
+	}
+	fclose(f);
+	if ((ReplayLines == 0) || (end <= Replay[ReplayLines-1].cycle)) {
+		fprintf(stderr, "%s: no \"end\" line (or it is too early)\n", name);
+		return 1;
+	}
+	ReplayEnd = end;
+	return 0;
+}
+
+
+//
+// turn the recording into a table for setreplay(), as tools/replayc does
+//
+static void makereplaytable(void)
+{
+	uint32_t i, n, cycles, run;
+	uint8_t *p;
+
+	ReplayTable = malloc((ReplayEnd / 255 + ReplayLines + 1) * 2);	// (plenty)
+	if (ReplayTable == NULL) {
+		fprintf(stderr, "migemu: out of memory\n");
+		exit(1);
+	}
+	p = ReplayTable;
+	for (i = 0; i < ReplayLines; i = n) {
+		for (n = i+1; (n < ReplayLines) && (Replay[n].mask == Replay[i].mask); n++) {
+			;		// (lines that only change the frame hash are merged)
+		}
+		cycles = ((n < ReplayLines) ? Replay[n].cycle : ReplayEnd) - Replay[i].cycle;
+		while (cycles) {
+			run = (cycles > 255) ? 255 : cycles;
+			*p++ = run;
+			*p++ = Replay[i].mask;
+			cycles -= run;
+		}
+	}
+	*p++ = 0;
+	*p++ = 0;
+}
+
+
+static void checkreplay(void)
+{
+	uint16_t hash;
+
+	while ((ReplayLine+1 < ReplayLines) && (Replay[ReplayLine+1].cycle <= Cycles)) {
+		ReplayLine++;
+	}
+	hash = framehash();
+	if (hash != Replay[ReplayLine].hash) {
+		term_restore();
+		printf("replay: different frame at cycle %lu (%.2f sec): hash %04x, expected %04x\n",
+			(unsigned long)Cycles, (double)Cycles / 100, hash, Replay[ReplayLine].hash);
+		exit(1);
+	}
+	if (Cycles + 1 >= ReplayEnd) {
+		term_restore();
+		printf("replay ok: %lu cycles (%.2f sec) in %.3f sec\n", (unsigned long)ReplayEnd,
+			(double)ReplayEnd / 100, now() - StartTime);
+		exit(0);
+	}
+}
+
+
+//
+// display
+//
+
+static void draw(void)
+{
+	static const char *Pixel[4] = {
+		"\033[90m . ",			// off
+		"\033[91m(@)",			// red
+		"\033[92m(@)",			// green
+		"\033[93m(@)",			// yellow
+	};
+	uint8_t x, y, bit, c;
+	double t;
+
+	printf("\033[H\n");
+	for (y = 0; y < 5; y++) {
+		printf("   ");
+		for (x = 0, bit = 0x40; x < 7; x++, bit >>= 1) {
+			c = ((Disp[y+5] & bit) ? 1 : 0) | ((Disp[y] & bit) ? 2 : 0);
+			printf("%s", Pixel[c]);
+		}
+		printf("\033[0m\n");
+	}
+	t = (double)HostTicks / HOST_TICK_HZ;
+	printf("\n   %02d:%05.2f  buttons %c%c%c%c  ", (int)(t / 60), t - 60 * (int)(t / 60),
+		(PINC & _BV(PC1)) ? 'A' : '-', (PINC & _BV(PC2)) ? 'B' : '-',
+		(PINC & _BV(PC3)) ? 'C' : '-', (PINC & _BV(PC4)) ? 'D' : '-');
+	if (Speed != 1.0) {
+		if (Speed == 0) {
+			printf("(fast)   ");
+		} else {
+			printf("(x%g)   ", Speed);
+		}
+	}
+	printf("\n\n   a s d f: buttons   A S D F: hold   q: quit\033[K\n");
+	fflush(stdout);
+}
+
+
+//
+// called after every tick of the ISR
+//
+static void tick(void)
+{
+	uint8_t i, val;
+	double t;
+
+	val = host_speaker();
+	if (WavFile != NULL) {
+		host_wavput(WavFile, val);
+	}
+	if (Player != NULL) {
+		AudioBuf[AudioCount++] = val * 255 / (ICR1 + 1);
+		if (AudioCount == AUDIO_BUF) {
+			fwrite(AudioBuf, 1, AUDIO_BUF, Player);
+			AudioCount = 0;
+		}
+	}
+
+	for (i = 0; i < 4; i++) {
+		if (PressTicks[i]) {
+			PressTicks[i]--;
+		}
+	}
+
+	if (HostTicks % CYCLE_TICKS) {
+		return;
+	}
+
+	// once per display cycle (the switches have just been read for cycle Cycles)
+	if (RecFile != NULL) {
+		record();
+	}
+	if (Replay != NULL) {
+		checkreplay();
+	}
+	Cycles++;
+
+	t = (double)HostTicks / HOST_TICK_HZ;
+	if ((Speed > 0) && !Quit) {
+		sleep_until(StartTime + t / Speed);
+	}
+	readkeys();
+	setbuttons();
+	if (Quit || ((StopTime > 0) && (t >= StopTime))) {
+		exit(0);
+	}
+	if (!NoDisplay && RawTerm) {
+		if ((now() - LastDraw >= DRAW_MS / 1000.0)
+			&& (!Drawn || (memcmp(LastDisp, (const void *)Disp, sizeof(LastDisp)) != 0)
+				|| (now() - LastDraw >= 0.25))) {
+			memcpy(LastDisp, (const void *)Disp, sizeof(LastDisp));
+			Drawn = 1;
+			LastDraw = now();
+			draw();
+		}
+	}
+}
+
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: migemu [-x speed] [-t seconds] [-w file.wav] [-p] [-n]"
+		" [-r file.log | -R file.log]\n");
+	exit(1);
+}
+
+
+int main(int argc, char **argv)
+{
+	char cmd[64];
+	int i, play;
+
+	play = 0;
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-x") == 0) && (i+1 < argc)) {
+			Speed = atof(argv[++i]);
+		} else if ((strcmp(argv[i], "-t") == 0) && (i+1 < argc)) {
+			StopTime = atof(argv[++i]);
+		} else if ((strcmp(argv[i], "-w") == 0) && (i+1 < argc)) {
+			WavFile = host_wavopen(argv[++i]);
+			if (WavFile == NULL) {
+				return 1;
+			}
+		} else if (strcmp(argv[i], "-p") == 0) {
+			play = 1;
+		} else if (strcmp(argv[i], "-n") == 0) {
+			NoDisplay = 1;
+		} else if ((strcmp(argv[i], "-r") == 0) && (i+1 < argc)) {
+			RecFile = fopen(argv[++i], "w");
+			if (RecFile == NULL) {
+				perror(argv[i]);
+				return 1;
+			}
+			fprintf(RecFile, "# migemu recording: cycle buttons framehash\n");
+		} else if ((strcmp(argv[i], "-R") == 0) && (i+1 < argc)) {
+			if (readreplay(argv[++i]) != 0) {
+				return 1;
+			}
+		} else {
+			usage();
+		}
+	}
+	if (Speed < 0) {
+		usage();
+	}
+	if (play) {
+		if (Speed != 1.0) {
+			fprintf(stderr, "migemu: -p only works at real time (-x 1)\n");
+			return 1;
+		}
+		snprintf(cmd, sizeof(cmd), "aplay -q -t raw -f U8 -c 1 -r %d", HOST_TICK_HZ);
+		Player = popen(cmd, "w");
+		if (Player == NULL) {
+			perror("aplay");
+			return 1;
+		}
+	}
+
+	atexit(finish);
+	signal(SIGINT, onsignal);
+	signal(SIGTERM, onsignal);
+	if (!NoDisplay) {
+		term_raw();
+	}
+
+	if (Replay != NULL) {
+		makereplaytable();
+		setreplay(ReplayTable);
+	}
+	HostTickHook = tick;
+	StartTime = now();
+	game_main();
+	return 0;
+}
@@ -0,0 +1,24 @@
+/*
+ *	host/util/atomic.h - stand-in for <util/atomic.h>
+ *
+ *	the ISR never runs in the middle of main code on the host (see host/avr/interrupt.h),
+ *	so an ATOMIC_BLOCK just runs its body once.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#include <stdint.h>
+
+#define ATOMIC_RESTORESTATE		1
+#define ATOMIC_FORCEON			1
+
+#define ATOMIC_BLOCK(type)		for (uint8_t host_atomic_ = (type); host_atomic_; host_atomic_ = 0)
+
+#endif
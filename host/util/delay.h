@@ -0,0 +1,22 @@
+/*
+ *	host/util/delay.h - stand-in for <util/delay.h>
+ *
+ *	delays run the timer ISR for as many ticks as the delay lasts (see hostsim.c),
+ *	so code that waits on the display or audio behaves as it does on the AVR.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+void host_delay_us(double us);
+
+#define _delay_us(us)	host_delay_us(us)
+#define _delay_ms(ms)	host_delay_us((ms) * 1000.0)
+
+#endif
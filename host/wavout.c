@@ -0,0 +1,617 @@
+/*
+ *	wavout.c - renders miggl audio to a WAV file on the host, checks it against golden
+ *	outputs, and benchmarks the synthesizer.
+ *
+ *	the timer ISR in miggl.c is run once per tick (see hostsim.c), and the value on
+ *	the speaker pin (OCR1A while the speaker is on, otherwise 0) is taken as one sample.
+ *	so the WAV file is what the speaker is driven with, at the real sample rate.
+ *
+ *	usage:
+ *		wavout -l					list the test cases
+ *		wavout -o file.wav case		render a case to a WAV file (8 bit mono, AUDIO_RATE)
+ *		wavout -g					print a golden line (length and CRC) for every case
+ *		wavout -c golden.txt		check every case against golden.txt (see "make check")
+ *		wavout -b					benchmark: ticks (samples) per second, and host cost per tick
+ *
+ *	build wavout-fifo (see the Makefile) to run the same cases with AUDIO_FIFO.  its golden
+ *	lines have "-fifo" after the case name, since rendering ahead changes when commands
+ *	are picked up.  builds at other sample rates (wavout-8000, etc, see AUDIO_RATES in the
+ *	Makefile) add the rate, e.g. "-8000hz".
+ *
+ *	after changing the synthesizer on purpose, check the new sound with -o, then
+ *	"make golden" to update golden.txt.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+#include "mydefs.h"
+#include "miggl.h"
+#include "miggl-private.h"		// (for WT_SCALED() and WT_MORPH())
+#include "hostsim.h"
+
+
+#define TAIL_TICKS		200				// ticks rendered after the audio is finished
+#define MAX_TICKS		(60UL*HOST_TICK_HZ)	// give up after a minute
+
+#ifdef AUDIO_FIFO
+#define FIFO_SUFFIX		"-fifo"
+#else
+#define FIFO_SUFFIX		""
+#endif
+
+#define BASE_RATE		20000			// builds at other rates have "-<rate>hz" in their golden lines
+
+static char BuildSuffix[32];			// e.g. "-fifo-8000hz" (see main())
+
+
+//
+// test cases - each one starts from initaudio() and sets up some audio to play
+//
+
+static byte ScaleSong[] = {
+	N_C4,N_8TH, N_D4,N_8TH, N_E4,N_8TH, N_F4,N_8TH, N_G4,N_8TH, N_A4,N_8TH, N_B4,N_8TH, N_C5,N_QUARTER,
+	N_END
+};
+
+static byte BassSong[] = {
+	N_C3,N_QUARTER, N_G3,N_QUARTER, N_A3,N_QUARTER, N_F3,N_QUARTER,
+	N_END
+};
+
+static byte ChirpSfx[] = {
+	N_C5,N_16TH, N_E5,N_16TH, N_G5,N_16TH, N_C6,N_16TH,
+	N_END
+};
+
+static byte DrumSong[] = {
+	S_REPEAT,4, N_C3,N_8TH, N_REST,N_8TH, N_C6,N_16TH, N_REST,N_16TH, N_C5,N_8TH, S_ENDREPEAT,0,
+	N_END
+};
+
+// tempo changes mid-song: each note should be 3 units at its own tempo (125, 250 and 62.5 ms)
+static byte TempoSong[] = {
+	N_C4,N_16TH, S_TEMPO,60, N_E4,N_16TH, S_TEMPO,240, N_G4,N_16TH, N_REST,N_16TH,
+	N_END
+};
+
+static byte Phrase0[] = { N_C4,N_16TH, N_E4,N_16TH, N_G4,N_8TH, N_END };
+static byte Phrase1[] = { S_REPEAT,2, N_A4,N_16TH, S_ENDREPEAT,0, N_END };
+static byte *Phrases[] = { Phrase0, Phrase1 };
+
+static byte CommandSong[] = {
+	S_TEMPO,160,
+	S_CALL,0,
+	S_TRANSPOSE,5, S_CALL,0,
+	S_WAVE,WT_SINE, S_TRANSPOSE,(byte)-12, S_CALL,1,
+	S_TRANSPOSE,0, S_REPEAT,2, S_CALL,1, N_B4,N_16TH, S_ENDREPEAT,0,
+	S_WAVE,WT_SQUARE, N_C5,N_QUARTER,
+	N_END
+};
+
+static const byte TrackPatterns[] PROGMEM = {
+	N_C4, T_HOLD, N_E4, T_HOLD, N_G4, T_HOLD, N_REST, T_HOLD,		// 0: arpeggio
+	N_C3, T_HOLD, T_HOLD, T_HOLD, N_G3, T_HOLD, T_HOLD, T_HOLD,		// 1: bass
+	N_A3, T_HOLD, N_C4, N_E4, T_HOLD, T_HOLD, T_HOLD, T_HOLD,		// 2: held over the pattern end
+};
+static const byte TrackOrder0[] PROGMEM = { 0, 2, 0, TRK_END };
+static const byte TrackOrder1[] PROGMEM = { 1, 1, 1, TRK_END };
+static const struct tracksong TrackSong = {
+	TrackPatterns, 8, N_16TH, { TrackOrder0, TrackOrder1 }
+};
+
+// "P: t140 l8 o4 c e g >c<g e c4 r8 d+16 f16 g2" from tools/songc
+static const byte PackedSong[] PROGMEM = {
+	0x1f, 0xf4, 0x8c, 0x2f, 0x33, 0x32, 0x34, 0x2a, 0x2c, 0x4b, 0x3e, 0x12,
+	0x11, 0x71, 0x1f, 0x00,
+};
+
+// a 30ms falling zap, from tools/samplec (as DPCM at 8000 Hz, and with -p -r 4000)
+static const byte ZapDpcmData[] PROGMEM = {
+	0xfe, 0xff, 0x00, 0x00, 0xf4, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xff,
+	0x00, 0x20, 0xff, 0xff, 0xff, 0x01, 0x00, 0xf8, 0xff, 0xff, 0x2f, 0x00,
+	0x10, 0xff, 0xff, 0xff, 0x3f, 0x00, 0x10, 0xf3, 0xff, 0xff, 0xff, 0x1b,
+	0x00, 0x20, 0xc3, 0xff, 0xff, 0xff, 0x4f, 0x12, 0x10, 0x11, 0x73, 0xec,
+	0xff, 0xff, 0xef, 0x8b, 0x23, 0x12, 0x21, 0x31, 0x33, 0xb9, 0xed, 0xee,
+	0xfe, 0xde, 0xdd, 0xab, 0x46, 0x34, 0x23, 0x23, 0x33, 0x42, 0x34, 0x55,
+	0x77, 0x99, 0xba, 0xbc, 0xcb, 0xcc, 0xcc, 0xcc, 0xbb, 0xbc, 0xbb, 0xab,
+	0xaa, 0x9a, 0x99, 0x89, 0x89, 0x88, 0x88, 0x87, 0x87, 0x77, 0x76, 0x67,
+	0x66, 0x56, 0x56, 0x55, 0x64, 0x45, 0x55, 0x45, 0x65, 0x65, 0x76, 0x88,
+	0xa9, 0xba, 0xbc, 0xdc, 0xcd, 0xdc, 0xcc, 0xcb, 0x8a, 0x57, 0x44, 0x04,
+};
+static const struct sample ZapDpcm = { ZapDpcmData, 239, 8000, SAMPLE_DPCM4 };
+static const byte ZapPcmData[] PROGMEM = {
+	0xb4, 0xe2, 0x71, 0x1a, 0x63, 0xd7, 0xc7, 0x4e, 0x1f, 0x7c, 0xdc, 0xbd,
+	0x4f, 0x23, 0x6d, 0xcc, 0xcf, 0x73, 0x28, 0x43, 0x9f, 0xd7, 0xb5, 0x5d,
+	0x29, 0x4b, 0x9c, 0xd1, 0xbf, 0x76, 0x38, 0x36, 0x6d, 0xb0, 0xd0, 0xb5,
+	0x77, 0x42, 0x35, 0x57, 0x95, 0xc1, 0xc7, 0xa9, 0x77, 0x4b, 0x39, 0x47,
+	0x6d, 0x99, 0xb9, 0xc4, 0xb6, 0x97, 0x72, 0x52, 0x42, 0x42, 0x52, 0x6c,
+	0x89, 0xa3, 0xb5, 0xbd, 0xb9, 0xad, 0x9b, 0x87, 0x73, 0x62, 0x54, 0x4c,
+	0x49, 0x49, 0x4e, 0x55, 0x5e, 0x67, 0x71, 0x7b, 0x83, 0x8a, 0x90, 0x95,
+	0x99, 0x9c, 0x9f, 0xa0, 0xa1, 0xa1, 0xa1, 0xa0, 0x9f, 0x9d, 0x9b, 0x98,
+	0x94, 0x8f, 0x8a, 0x84, 0x7e, 0x77, 0x70, 0x69, 0x62, 0x5d, 0x5a, 0x59,
+	0x5b, 0x60, 0x68, 0x73, 0x7f, 0x8c, 0x98, 0xa0, 0xa4, 0xa1, 0x99,
+};
+static const struct sample ZapPcm = { ZapPcmData, 119, 4000, SAMPLE_PCM8 };
+
+// a narrow pulse, and a two harmonic organ, as custom tables and a 3 step morph between them
+#define PULSE_VALUES \
+ 49, 49, 49, 49, 49, 49, 49, 49, \
+  0,  0,  0,  0,  0,  0,  0,  0, \
+  0,  0,  0,  0,  0,  0,  0,  0, \
+  0,  0,  0,  0,  0,  0,  0,  0
+
+#define ORGAN_VALUES \
+ 25, 35, 42, 45, 43, 38, 32, 27, \
+ 25, 27, 32, 38, 43, 45, 42, 35, \
+ 25, 15,  8,  5,  7, 12, 18, 23, \
+ 25, 23, 18, 12,  7,  5,  8, 15
+
+static const uint8_t PulseWtable[WT_LEVELS-1][WTABSIZE] PROGMEM = WT_SCALED(PULSE_VALUES);
+
+#define PULSE_ORGAN(k)	WT_MORPH(k, 3, PULSE_VALUES, ORGAN_VALUES)
+static const uint8_t PulseOrgan[4][WT_LEVELS-1][WTABSIZE] PROGMEM = {
+	PULSE_ORGAN(0), PULSE_ORGAN(1), PULSE_ORGAN(2), PULSE_ORGAN(3)
+};
+
+
+static void case_scale(void)
+{
+	playsong(ScaleSong);
+}
+
+static void case_mix(void)
+{
+	setvoicewavetable(1, WT_SINE);
+	playsong(ScaleSong);
+	playsongvoice(1, BassSong);
+	host_run(HOST_TICK_HZ/4);
+	playsfx(ChirpSfx, SFX_MEDIUM);		// music ducks under the effect
+}
+
+static void case_override(void)
+{
+	setsfxmode(SFX_OVERRIDE);
+	playsong(ScaleSong);
+	host_run(HOST_TICK_HZ/4);
+	playsfx(ChirpSfx, SFX_HIGH);
+}
+
+static void case_envelope(void)
+{
+	setwavetable(WT_SQUARE);
+	setenvelope(0, 20, 100, 128, 150);
+	setvolume(MAX_VOLUME/2);
+	playsong(ScaleSong);
+}
+
+static void case_noise(void)
+{
+	setvoicewavetable(0, WT_NOISE);
+	setenvelope(0, 0, 80, 0, 0);
+	settempo(140);
+	playsong(DrumSong);
+}
+
+static void case_commands(void)
+{
+	setsongphrases(Phrases);
+	playsong(CommandSong);
+}
+
+static void case_tempo(void)
+{
+	setenvelope(0, 0, 30, 0, 0);		// (short notes, so each one's start shows)
+	playsong(TempoSong);
+}
+
+static void case_tracker(void)
+{
+	setvoicewavetable(1, WT_SQUARE);
+	setvoicevolume(1, MAX_VOLUME*2/3);
+	playtracker(&TrackSong);
+}
+
+static void case_packed(void)
+{
+	setwavetable(WT_SINE);
+	playpackedsong(0, PackedSong);
+}
+
+static void case_notes(void)
+{
+	playnote(N_A4, N_8TH);
+	playnote(N_REST, N_16TH);
+	playnote(N_E5, N_8TH);
+	playsound(1000, 100);
+	playsound(250, 150);
+}
+
+static void case_sounds(void)
+{
+	settempo(40);						// (playsound() doesn't go by the tempo)
+	playsound(800, 10);
+	playsound(800, 30);
+	playsound(400, 100);
+}
+
+static void case_sample(void)
+{
+	playsong(BassSong);
+	playsample(1, &ZapPcm);
+	host_run(HOST_TICK_HZ/4);
+	playsfxsample(&ZapDpcm, SFX_MEDIUM);
+}
+
+static void case_silent(void)
+{
+	setvoicevolume(1, 0);
+	playsample(1, &ZapPcm);
+	waitaudio();						// (this hung when a silent sample never ended)
+	playnote(N_A4, N_8TH);
+}
+
+static void case_queued(void)
+{
+	playsample(0, &ZapDpcm);
+	playnote(N_E5, N_8TH);				// (these wait for the sample to end)
+	playsound(1000, 50);
+}
+
+static void case_wavetables(void)
+{
+	setcustomwavetable(WT_CUSTOM, PulseWtable[0]);
+	setvoicewavetable(1, WT_CUSTOM);
+	setvoicemorph(0, PulseOrgan[0][0], 4, 40);		// each note sweeps from pulse to organ
+	playsong(ScaleSong);
+	playsongvoice(1, BassSong);
+	host_run(HOST_TICK_HZ);
+	setvoicemorph(0, PulseOrgan[0][0], 4, 0);		// a table further on for each note
+	playsong(ScaleSong);
+}
+
+struct testcase {
+	const char *name;
+	void (*setup)(void);
+	const char *desc;
+};
+
+static const struct testcase Cases[] = {
+	{ "scale",		case_scale,		"one voice, sawtooth, default envelope" },
+	{ "mix",		case_mix,		"two voices, with a sound effect ducking them" },
+	{ "override",	case_override,	"sound effect with SFX_OVERRIDE" },
+	{ "envelope",	case_envelope,	"square wave, ADSR envelope, half volume" },
+	{ "noise",		case_noise,		"WT_NOISE drums with a decay envelope" },
+	{ "commands",	case_commands,	"song commands: repeats, phrases, transpose, tempo, wave" },
+	{ "tempo",		case_tempo,		"S_TEMPO changes that take effect on the next note" },
+	{ "tracker",	case_tracker,	"tracker song on two voices" },
+	{ "packed",		case_packed,	"packed song from tools/songc" },
+	{ "notes",		case_notes,		"playnote() and playsound()" },
+	{ "sounds",		case_sounds,	"short playsound() tones, timed in ms at a slow tempo" },
+	{ "sample",		case_sample,	"PCM sample over a song, then a DPCM sound effect sample" },
+	{ "silent",		case_silent,	"a sample at volume 0 still ends, then a note" },
+	{ "queued",		case_queued,	"a note and a sound queued behind a sample on voice 0" },
+	{ "wavetables",	case_wavetables,	"custom wavetable, and morphs during and across notes" },
+};
+
+#define NUM_CASES	(sizeof(Cases) / sizeof(Cases[0]))
+
+
+//
+// rendering
+//
+
+static uint8_t *Samples;		// speaker values of the current render
+static uint32_t NumSamples;
+static uint32_t MaxSamples;
+static uint8_t Recording;
+
+
+static void record_tick(void)
+{
+	if (!Recording) {
+		return;
+	}
+	if (NumSamples >= MaxSamples) {
+		MaxSamples = (MaxSamples == 0) ? HOST_TICK_HZ : MaxSamples*2;
+		Samples = realloc(Samples, MaxSamples);
+		if (Samples == NULL) {
+			fprintf(stderr, "wavout: out of memory\n");
+			exit(1);
+		}
+	}
+	Samples[NumSamples++] = host_speaker();
+}
+
+
+//
+// run until the audio is done (and a little longer, for the end of the release)
+//
+static void run_audio(uint32_t maxticks)
+{
+	uint32_t start, tail;
+
+	start = HostTicks;
+	tail = TAIL_TICKS;
+	while (tail && (HostTicks - start < maxticks)) {
+		if (!isaudioplaying()) {
+			tail--;
+		}
+		fillaudio();
+		host_tick();
+	}
+}
+
+
+static void render(const struct testcase *c)
+{
+	avrinit();
+	initaudio();
+	start_timer1();
+
+	NumSamples = 0;
+	Recording = 1;
+	c->setup();
+	run_audio(MAX_TICKS);
+	Recording = 0;
+}
+
+
+static uint32_t crc32(const uint8_t *p, uint32_t n)
+{
+	uint32_t crc;
+	int k;
+
+	crc = 0xffffffff;
+	while (n--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++) {
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+
+static int writewav(const char *name)
+{
+	FILE *f;
+	uint32_t i;
+
+	f = host_wavopen(name);
+	if (f == NULL) {
+		return 1;
+	}
+	for (i = 0; i < NumSamples; i++) {
+		host_wavput(f, Samples[i]);
+	}
+	if (host_wavclose(f) != 0) {
+		fprintf(stderr, "wavout: error writing %s\n", name);
+		return 1;
+	}
+	return 0;
+}
+
+
+static const struct testcase *findcase(const char *name)
+{
+	unsigned i;
+
+	for (i = 0; i < NUM_CASES; i++) {
+		if (strcmp(Cases[i].name, name) == 0) {
+			return &Cases[i];
+		}
+	}
+	fprintf(stderr, "wavout: no case \"%s\" (see wavout -l)\n", name);
+	return NULL;
+}
+
+
+static void golden(FILE *out)
+{
+	unsigned i;
+
+	for (i = 0; i < NUM_CASES; i++) {
+		render(&Cases[i]);
+		fprintf(out, "%s%s %lu %08lx\n", Cases[i].name, BuildSuffix,
+			(unsigned long)NumSamples, (unsigned long)crc32(Samples, NumSamples));
+	}
+}
+
+
+//
+// render every case and compare it with its line in the golden file
+//
+static int check(const char *goldname)
+{
+	char line[256], name[128], want[256];
+	FILE *f;
+	unsigned i;
+	int fails;
+
+	fails = 0;
+	for (i = 0; i < NUM_CASES; i++) {
+		f = fopen(goldname, "r");
+		if (f == NULL) {
+			perror(goldname);
+			return 1;
+		}
+		snprintf(name, sizeof(name), "%s%s ", Cases[i].name, BuildSuffix);
+		want[0] = '\0';
+		while (fgets(line, sizeof(line), f) != NULL) {
+			line[strcspn(line, "\r\n")] = '\0';
+			if (strncmp(line, name, strlen(name)) == 0) {
+				snprintf(want, sizeof(want), "%s", line);
+				break;
+			}
+		}
+		fclose(f);
+
+		render(&Cases[i]);
+		snprintf(line, sizeof(line), "%s%lu %08lx", name,
+			(unsigned long)NumSamples, (unsigned long)crc32(Samples, NumSamples));
+		if (want[0] == '\0') {
+			printf("MISSING %s\n", line);
+			fails++;
+		} else if (strcmp(line, want) != 0) {
+			printf("FAIL    %s (expected %s)\n", line, want);
+			fails++;
+		} else {
+			printf("ok      %s\n", line);
+		}
+	}
+	return fails != 0;
+}
+
+
+//
+// benchmark
+//
+// these are times and cycles of the host's CPU, running the host build.  they are only good
+// for comparing changes to the synthesizer (or voice counts) with each other: they don't say
+// what the ISR costs on the AVR.  the AVR's whole budget is F_CPU/AUDIO_RATE cycles a tick.
+//
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t cycles(void)
+{
+	uint32_t lo, hi;
+
+	__asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t)hi << 32) | lo;
+}
+#define HAVE_CYCLES
+#endif
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static byte LongSong[] = {
+	S_REPEAT,0, N_C4,N_WHOLE, N_G4,N_WHOLE, S_ENDREPEAT,0,
+	N_END
+};
+
+static void bench_one(const char *name, byte nvoices)
+{
+	uint32_t n, i;
+	double t;
+#ifdef HAVE_CYCLES
+	uint64_t c;
+#endif
+
+	avrinit();
+	initaudio();
+	start_timer1();
+	for (i = 0; i < nvoices; i++) {
+		playsongvoice(i, LongSong);
+	}
+	host_run(HOST_TICK_HZ/10);		// let the commands get picked up and the attacks finish
+
+	n = 20UL * HOST_TICK_HZ;		// 20 seconds of audio
+	t = now();
+#ifdef HAVE_CYCLES
+	c = cycles();
+#endif
+	for (i = 0; i < n; i++) {
+		fillaudio();
+		host_tick();
+	}
+#ifdef HAVE_CYCLES
+	c = cycles() - c;
+#endif
+	t = now() - t;
+
+	printf("%-10s %12.0f %10.1f %10.0fx", name, n / t, t * 1e9 / n, n / t / HOST_TICK_HZ);
+#ifdef HAVE_CYCLES
+	printf(" %10.1f", (double)c / n);
+#endif
+	printf("\n");
+}
+
+
+static void bench(void)
+{
+	char name[sizeof(BuildSuffix) + 12];		// (room for the voice count too)
+	byte v;
+
+	printf("%-10s %12s %10s %11s", "voices", "ticks/sec", "ns/tick", "realtime");
+#ifdef HAVE_CYCLES
+	printf(" %10s", "host cyc/tk");
+#endif
+	printf("\n");
+	for (v = 0; v <= NUM_VOICES; v++) {
+		snprintf(name, sizeof(name), "%d%s", v, BuildSuffix);
+		bench_one(name, v);
+	}
+	printf("(one tick is one sample, and the whole timer ISR, at %d Hz)\n", HOST_TICK_HZ);
+	printf("(host figures only - the AVR has %lu cycles a tick in all, at %lu Hz)\n",
+		(unsigned long)(F_CPU / HOST_TICK_HZ), (unsigned long)F_CPU);
+}
+
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: wavout -l | -o file.wav case | -g | -c golden.txt | -b\n");
+	exit(1);
+}
+
+
+int main(int argc, char **argv)
+{
+	const struct testcase *c;
+	unsigned i;
+
+	HostTickHook = record_tick;
+
+	if (HOST_TICK_HZ == BASE_RATE) {
+		snprintf(BuildSuffix, sizeof(BuildSuffix), "%s", FIFO_SUFFIX);
+	} else {
+		snprintf(BuildSuffix, sizeof(BuildSuffix), "%s-%dhz", FIFO_SUFFIX, HOST_TICK_HZ);
+	}
+
+	if (argc < 2) {
+		usage();
+	}
+	if (strcmp(argv[1], "-l") == 0) {
+		for (i = 0; i < NUM_CASES; i++) {
+			printf("%-10s %s\n", Cases[i].name, Cases[i].desc);
+		}
+	} else if ((strcmp(argv[1], "-o") == 0) && (argc == 4)) {
+		c = findcase(argv[3]);
+		if (c == NULL) {
+			return 1;
+		}
+		render(c);
+		if (writewav(argv[2]) != 0) {
+			return 1;
+		}
+		printf("%s: %lu samples (%.2f sec)\n", argv[2], (unsigned long)NumSamples,
+			(double)NumSamples / HOST_TICK_HZ);
+	} else if (strcmp(argv[1], "-g") == 0) {
+		golden(stdout);
+	} else if ((strcmp(argv[1], "-c") == 0) && (argc == 3)) {
+		return check(argv[2]);
+	} else if (strcmp(argv[1], "-b") == 0) {
+		bench();
+	} else {
+		usage();
+	}
+	return 0;
+}
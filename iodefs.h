@@ -1,169 +1,219 @@
-/*
- *	iodefs.h - project-specific I/O pin definitions and some macros/functions to go with them
- *
- *		the inline functions, output_high() and output_low(), allow a simple syntax for
- *		setting/clearing I/O pins without having to remember which port (e.g. PORTA, PORTB, etc)
- *		the pin is assigned to.
- *		similarly, the inline function input_test() allows reading a pin.
- *
- *		for example, to set the SPKR I/O pin high (PB1), we do:
- *			output_high(SPKR);
- *
- *		because these are inline functions, they generate efficient code.  (1 instruction)
- *
- *		note: each I/O pin still needs to be configured as input or output.
- *		this is typically done in the avrinit() function.
- *
- *
- *	author: rolf van widenfelt (rolfvw@pizzicato.com)
- *
- *
- *	specific hardware setup:
- *
- *	- Mignonette v2.0 prototype hardware (atmega168)
- *
- *	revision history:
- *
- *	- dec 27, 2009 - rolf
- *		rework for Mig V.2 hardware (prototype version only!)
- *
- *	- apr 18, 2008 - rolf
- *		minor fix to input_test() to eliminate compiler warning.
- *		(control reaches end of non-void function)
- *
- *	- mar 18, 2008 - rolf
- *		rework for mignonette v0.1 pin definitions.
- *
- *	- 3/23/2007 - rolf
- *		created.
- *
- */
-
-//
-// note: simply add 0,8,16 or 24 for PORTA,B,C or D respectively, to the pin define for this AVR pin
-
-//#define _PA		0	/* no PORTA on atmega8/48/88/168 */
-
-#define _PB		8
-#define _PC		16
-#define _PD		24
-
-
-//
-// project-specific pin definitions go here.
-//
-// note: RxD (PD0) is used for the UART (as an input) and not available as an IO pin
-//
-// note: changes here MUST be updated in avrinit() too!  (see PORTn and DDRn settings)
-//
-// note: arrangement below of ROW1-ROW7 is for Mig V.2 prototype hardware only!
-//
-
-#define SWCOM		_PB+PB0
-#define SPKR		_PB+PB1
-#define RC5			_PB+PB2
-#define RC1			_PB+PB3
-#define RC2			_PB+PB4
-#define RC3			_PB+PB5
-//#define OSC1			_PB+PB6
-//#define OSC2			_PB+PB7
-
-#define RC4			_PC+PC0
-#define GC1			_PC+PC1
-#define GC2			_PC+PC2
-#define GC3			_PC+PC3
-#define GC4			_PC+PC4
-#define GC5			_PC+PC5
-
-//#define UNUSED		_PD+PD0
-#define ROW2		_PD+PD1
-#define ROW3		_PD+PD2
-#define ROW4		_PD+PD3
-#define ROW5		_PD+PD4
-#define ROW6		_PD+PD5
-#define ROW7		_PD+PD6
-#define ROW1		_PD+PD7
-
-// XXX need to replace SW1-SW4
-#define GC1_SW1		GC1
-#define GC2_SW2		GC2
-#define GC3_SW3		GC3
-#define GC4_SW4		GC4
-
-//
-// end of project-specific pin definitions.
-//
-
-
-//
-// private macros!
-// this is the recommended way to do a bit set/clear operation in avr-gcc
-// but this macro should only be used by the inline functions below.
-//
-
-#define _output_high(port,bit)	port |= _BV(bit)
-#define _output_low(port,bit)	port &= ~_BV(bit)
-
-
-#define _input_test(port,bit)	(port & _BV(bit))
-
-//
-// these inline functions will generate efficient code for I/O port bit set and clear operations.
-//
-// this determines the actual port by examining the pin number (e.g. PORTA is 0 - 7, PORTB is 8-15, etc)
-//
-
-static inline void output_high(unsigned char pin)
-{
-#ifdef NOTDEF
-	if (pin < 8) {
-		_output_high(PORTA,pin);
-	} else
-#endif
-	if (pin >= 8 && pin < 16) {
-		_output_high(PORTB,(pin-8));
-	} else if (pin >= 16 && pin < 24) {
-		_output_high(PORTC,(pin-16));
-	} else if (pin >= 24 && pin < 32) {
-		_output_high(PORTD,(pin-24));
-	}
-}
-
-static inline void output_low(unsigned char pin)
-{
-#ifdef NOTDEF
-	if (pin < 8) {
-		_output_low(PORTA,pin);
-	} else
-#endif
-	if (pin >= 8 && pin < 16) {
-		_output_low(PORTB,(pin-8));
-	} else if (pin >= 16 && pin < 24) {
-		_output_low(PORTC,(pin-16));
-	} else if (pin >= 24 && pin < 32) {
-		_output_low(PORTD,(pin-24));
-	}
-}
-
-//
-//	returns the value of the input pin (but does not shift it!)
-//
-//	note: the most efficient code is generated when testing the return value against 0.
-//
-static inline unsigned char input_test(unsigned char pin)
-{
-#ifdef NOTDEF
-	if (pin < 8) {
-		return _input_test(PINA,pin);
-	} else
-#endif
-	if (pin >= 8 && pin < 16) {
-		return _input_test(PINB,(pin-8));
-	} else if (pin >= 16 && pin < 24) {
-		return _input_test(PINC,(pin-16));
-	} else if (pin >= 24 && pin < 32) {
-		return _input_test(PIND,(pin-24));
-	} else {
-		return 0;	/* notreached */
-	}
-}
+/*
+ *	iodefs.h - project-specific I/O pin definitions and some macros/functions to go with them
+ *
+ *		the inline functions, output_high() and output_low(), allow a simple syntax for
+ *		setting/clearing I/O pins without having to remember which port (e.g. PORTA, PORTB, etc)
+ *		the pin is assigned to.
+ *		similarly, the inline function input_test() allows reading a pin.
+ *
+ *		for example, to set the SPKR I/O pin high (PB1), we do:
+ *			output_high(SPKR);
+ *
+ *		because these are inline functions, they generate efficient code.  (1 instruction,
+ *		but only when the pin is a compile-time constant - see below)
+ *
+ *		note: each I/O pin still needs to be configured as input or output.
+ *		this is typically done in the avrinit() function.
+ *
+ *
+ *	author: rolf van widenfelt (rolfvw@pizzicato.com)
+ *
+ *
+ *	specific hardware setup:
+ *
+ *	- Mignonette v2.0 prototype hardware (atmega168)
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		the PORTn/DDRn values for avrinit() are worked out from the pin definitions
+ *		(BOARD_DDRB, etc).
+ *		output_high(), output_low() and input_test() find the port by address arithmetic
+ *		instead of comparisons.
+ *		add pin_input(), pin_output(), ROW_PORT and ROW_BITS().
+ *		add PORT_OF() and SW_PIN, SW_SHIFT, etc, for reading the switches all at once.
+ *
+ *	- dec 27, 2009 - rolf
+ *		rework for Mig V.2 hardware (prototype version only!)
+ *
+ *	- apr 18, 2008 - rolf
+ *		minor fix to input_test() to eliminate compiler warning.
+ *		(control reaches end of non-void function)
+ *
+ *	- mar 18, 2008 - rolf
+ *		rework for mignonette v0.1 pin definitions.
+ *
+ *	- 3/23/2007 - rolf
+ *		created.
+ *
+ */
+
+//
+// note: simply add 0,8,16 or 24 for PORTA,B,C or D respectively, to the pin define for this AVR pin
+
+//#define _PA		0	/* no PORTA on atmega8/48/88/168 */
+
+#define _PB		8
+#define _PC		16
+#define _PD		24
+
+
+//
+// project-specific pin definitions go here.  these are for the Mig V.2 prototype, the only
+// board supported.
+//
+// the board also says which pins are outputs (BOARD_OUTPUTS) and which are set high
+// at startup (BOARD_HIGH), and how a row of the display buffer goes onto the row pins
+// (ROW_PORT and ROW_BITS()).  avrinit() sets up the ports from these.
+//
+// note: RxD (PD0) is used for the UART (as an input) and not available as an IO pin
+//
+
+#define SWCOM		_PB+PB0
+#define SPKR		_PB+PB1
+#define RC5			_PB+PB2
+#define RC1			_PB+PB3
+#define RC2			_PB+PB4
+#define RC3			_PB+PB5
+//#define OSC1			_PB+PB6
+//#define OSC2			_PB+PB7
+
+#define RC4			_PC+PC0
+#define GC1			_PC+PC1
+#define GC2			_PC+PC2
+#define GC3			_PC+PC3
+#define GC4			_PC+PC4
+#define GC5			_PC+PC5
+
+//#define UNUSED		_PD+PD0
+#define ROW2		_PD+PD1
+#define ROW3		_PD+PD2
+#define ROW4		_PD+PD3
+#define ROW5		_PD+PD4
+#define ROW6		_PD+PD5
+#define ROW7		_PD+PD6
+#define ROW1		_PD+PD7
+
+// the switches share pins with GC1-GC4 (see poll_switches() in miggl.c)
+#define GC1_SW1		GC1
+#define GC2_SW2		GC2
+#define GC3_SW3		GC3
+#define GC4_SW4		GC4
+
+#define BOARD_OUTPUTS(port)	(PIN_IN(SWCOM,port) | PIN_IN(SPKR,port) \
+		| PIN_IN(RC1,port) | PIN_IN(RC2,port) | PIN_IN(RC3,port) | PIN_IN(RC4,port) | PIN_IN(RC5,port) \
+		| PIN_IN(GC1,port) | PIN_IN(GC2,port) | PIN_IN(GC3,port) | PIN_IN(GC4,port) | PIN_IN(GC5,port) \
+		| PIN_IN(ROW1,port) | PIN_IN(ROW2,port) | PIN_IN(ROW3,port) | PIN_IN(ROW4,port) \
+		| PIN_IN(ROW5,port) | PIN_IN(ROW6,port) | PIN_IN(ROW7,port))
+
+#define BOARD_HIGH(port)	0		// everything starts low (no pullups)
+
+// display rows: the rows are all on PORTD.  the display buffer bits 0x40-0x02 (left to right)
+// line up with ROW7-ROW2 on PD6-PD1, and bit 0x01 goes to ROW1 on PD7.
+// (PD0 is RxD, an input, so it doesn't matter that it gets bit 0x01 too)
+#define ROW_PORT			PORTD
+#define ROW_BITS(d)			((uint8_t)((d) | ((d) << 7)))
+
+//
+// end of project-specific pin definitions.
+//
+
+
+//
+// ports, worked out from the pin number (these are constants when pin is a constant).
+//
+// on the atmega48/88/168 the PINx, DDRx and PORTx registers of ports B, C and D are
+// 3 apart, so the register is found by address arithmetic.  (host/avr/io.h does the same)
+//
+#define PIN_REG(pin)		(*(&PINB + 3 * (((pin) >> 3) - 1)))		// PINB, PINC or PIND
+#define DDR_REG(pin)		(*(&DDRB + 3 * (((pin) >> 3) - 1)))
+#define PORT_REG(pin)		(*(&PORTB + 3 * (((pin) >> 3) - 1)))
+#define PIN_MASK(pin)		_BV((pin) & 7)
+
+// PIN_MASK(pin) if pin is on port (_PB, _PC or _PD), otherwise 0
+#define PIN_IN(pin,port)	((((pin) & ~7) == (port)) ? PIN_MASK(pin) : 0)
+
+#define PORT_OF(pin)		((pin) & ~7)		// _PB, _PC or _PD
+
+// values for avrinit()
+#define BOARD_DDRB			BOARD_OUTPUTS(_PB)
+#define BOARD_DDRC			BOARD_OUTPUTS(_PC)
+#define BOARD_DDRD			BOARD_OUTPUTS(_PD)
+#define BOARD_PORTB			BOARD_HIGH(_PB)
+#define BOARD_PORTC			BOARD_HIGH(_PC)
+#define BOARD_PORTD			BOARD_HIGH(_PD)
+
+//
+// the switches are read all at once, as (SW_PIN >> SW_SHIFT) & 0xf  (see poll_switches() in
+// miggl.c), so SW1-SW4 must be next to each other, in order, on one port.  and SWCOM must be
+// on another port, since the two ports are written whole.
+//
+#define SW_PIN				PIN_REG(GC1_SW1)
+#define SW_DDR				DDR_REG(GC1_SW1)
+#define SW_PORT				PORT_REG(GC1_SW1)
+#define SW_SHIFT			((GC1_SW1) & 7)
+#define SW_MASK				(0xf << SW_SHIFT)
+
+#if (GC2_SW2 != GC1_SW1+1) || (GC3_SW3 != GC1_SW1+2) || (GC4_SW4 != GC1_SW1+3) || (SW_SHIFT > 4)
+#error "SW1-SW4 must be next to each other, in order, on one port"
+#endif
+#if PORT_OF(SWCOM) == PORT_OF(GC1_SW1)
+#error "SWCOM can't be on the same port as SW1-SW4"
+#endif
+
+
+//
+// private macros!
+// this is the recommended way to do a bit set/clear operation in avr-gcc
+// but this macro should only be used by the inline functions below.
+//
+
+#define _output_high(port,bit)	port |= _BV(bit)
+#define _output_low(port,bit)	port &= ~_BV(bit)
+
+
+#define _input_test(port,bit)	(port & _BV(bit))
+
+//
+// these inline functions will generate efficient code for I/O port bit set and clear operations.
+//
+// only a compile-time constant pin gives one instruction (sbi, cbi, or sbic/sbis for
+// input_test()).  with a variable pin, the port is found without any comparisons, but it is
+// still a pointer worked out at run time, and output_high()/output_low() become a read, modify
+// and write of the whole port.  that is several instructions, and isn't atomic: an ISR that
+// writes the same port in between would be undone.  (code that loops over pins is quicker
+// with a table of PIN_MASK() values for one port, written with interrupts off if need be)
+//
+
+static inline void output_high(unsigned char pin)
+{
+	PORT_REG(pin) |= PIN_MASK(pin);
+}
+
+static inline void output_low(unsigned char pin)
+{
+	PORT_REG(pin) &= ~PIN_MASK(pin);
+}
+
+//
+//	returns the value of the input pin (but does not shift it!)
+//
+//	note: the most efficient code is generated when testing the return value against 0.
+//
+static inline unsigned char input_test(unsigned char pin)
+{
+	return PIN_REG(pin) & PIN_MASK(pin);
+}
+
+//
+// make a pin an input or an output
+//
+static inline void pin_input(unsigned char pin)
+{
+	DDR_REG(pin) &= ~PIN_MASK(pin);
+}
+
+static inline void pin_output(unsigned char pin)
+{
+	DDR_REG(pin) |= PIN_MASK(pin);
+}
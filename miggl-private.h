@@ -1,81 +1,474 @@
-/*
- *	miggl-private.h - Mignonette Game Library - internal (private) definitions (not part of API)
- *
- *	author(s): rolf van widenfelt (rolfvw at pizzicato dot com) (c) 2008 - Some Rights Reserved
- *
- *	author(s): mitch altman (c) 2008 - Some Rights Reserved
- *
- *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
- *		(attribution, non-commercial, share-alike)
- *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
- *
- *	revision history:
- *
- *	jan 14, 2010 - rolf
- *		move button_pressed() macro to here, but leave it commented for now.
- *
- *	- may 24, 2008 - rolf
- *		move MIN_NOTE constant to miggl.h.
- *
- *	- may 22, 2008 - rolf
- *		add another octave of notes, C3 to B3.  (note: we adjust MIN_NOTE constant!)
- *
- *	- may 18, 2008 - rolf
- *		cleanup tempo constants (used in DurTab array)
- *
- *	- may 16, 2008 - rolf
- *		more hacking on this...
- *
- *	- may 13, 2008 - rolf
- *		created (based on Mitch's audio.c and audio.h of 5/2)
- *
- *
- */
-
-
-//
-// check button state.  note: buttons are active high input pins
-// XXX we may not need this anymore
-//
-//#define button_pressed(pin)		((input_test(pin)==0)?0:1)
-
-
-/* private audio-related defs */
-
-
-// this is the size of all wave tables (in bytes) - seriously, don't change this!
-#define WTABSIZE 32
-
-#define TEMPOCONST 		1200000						// 20,000Hz * 60 sec
-
-#define DEFAULTTEMPO	120.0						// default tempo in BPM (usually 75.0)
-
-#define TEMPOBEAT		(TEMPOCONST/DEFAULTTEMPO)	// calculates duration value for a quarter note (1 beat)
-
-#define NOTE_SEP 200			// length of small pause at end of each note (to differentiate each new note)
-
-
-// fixed point number -- the integer part is as expected, the fractional part is a number divided by 256
-struct fixedPtNum {
-    uint8_t integ;  // left of the "decimal point"
-    uint8_t fract;  // right of the "decimal point" up to 255 (up to but not including 256, which represents "1") -- "integ" actually represents "integ"/256
-};
-
-
-// XXX fix.. these should be hidden (static) inside miggl.c
-extern uint16_t NoteTab[];
-extern uint16_t DurTab[];
-
-
-//
-// convert standard note value into a "delta" for stepping through the wavetable.
-// standard note values (e.g. N_C4 for C4, middle C) are used in the array passed to playsong().
-//
-// note: we use MIN_NOTE constant here to save bytes in NoteTab table.
-//
-#define GETNOTEDELTA(note)		(NoteTab[note-MIN_NOTE])
-
-//
-// convert standard duration constants (e.g. N_QUARTER) into actual ticks used by audio code
-//
-#define GETDURATION(dur)		(DurTab[dur-1])
+/*
+ *	miggl-private.h - Mignonette Game Library - internal (private) definitions (not part of API)
+ *
+ *	author(s): rolf van widenfelt (rolfvw at pizzicato dot com) (c) 2008 - Some Rights Reserved
+ *
+ *	author(s): mitch altman (c) 2008 - Some Rights Reserved
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		add struct voice, and the constants for multi-voice audio: per voice song, tracker,
+ *		packed song, sample, envelope, noise, morph and request state.  struct fixedPtNum is gone
+ *		(the wavetable position is a plain 8.8 uint16_t).
+ *		timing constants (TIMER1_TOP, TEMPOCONST, ROW_TICKS, CYCLE_TICKS, SCAN_TICKS, etc) are
+ *		worked out from F_CPU and AUDIO_RATE, with #error checks for combinations that can't
+ *		work, and the AUDIO_RATE presets are documented.  DurTab and GETDURATION() are gone -
+ *		durations are counted in units of a tempo divider (see TEMPOPERIOD()).
+ *		add WT_SCALED(), WT_MORPH() and LT_ROW(), for wavetables kept in flash at every level.
+ *		the mix scale (MIXNUM/MIXDEN, which replaces MIXSCALE) is built into them, as a fraction
+ *		of TOP at every AUDIO_RATE.  add SMP_ROW(), for scaling samples the same way.
+ *		add struct audiocmd (durations in units, or in ms with CMD_MS) and struct songframe.
+ *		add the packed song format (PACK_*), SONG_* request kinds, DPCM_STEPS and LFSR_TAPS.
+ *		add AUDIO_FIFO_SIZE and AUDIO_BLOCK, SCAN_PHASE, STACK_PAINT, and IDLE() for wait loops
+ *		in the host build.
+ *
+ *	jan 14, 2010 - rolf
+ *		move button_pressed() macro to here, but leave it commented for now.
+ *
+ *	- may 24, 2008 - rolf
+ *		move MIN_NOTE constant to miggl.h.
+ *
+ *	- may 22, 2008 - rolf
+ *		add another octave of notes, C3 to B3.  (note: we adjust MIN_NOTE constant!)
+ *
+ *	- may 18, 2008 - rolf
+ *		cleanup tempo constants (used in DurTab array)
+ *
+ *	- may 16, 2008 - rolf
+ *		more hacking on this...
+ *
+ *	- may 13, 2008 - rolf
+ *		created (based on Mitch's audio.c and audio.h of 5/2)
+ *
+ *
+ */
+
+
+//
+// check button state.  note: buttons are active high input pins
+// XXX we may not need this anymore
+//
+//#define button_pressed(pin)		((input_test(pin)==0)?0:1)
+
+
+//
+// called in loops that wait for the ISR (e.g. swapbuffers()).  on the host (see host/hostsim.h)
+// time only passes when we ask for it, so this runs the ISR.  on the AVR it is nothing.
+//
+#ifdef MIG_HOST
+void host_idle(void);
+#define IDLE()		host_idle()
+#else
+#define IDLE()
+#endif
+
+
+/* private audio-related defs */
+
+
+// this is the size of all wave tables (in bytes) - seriously, don't change this!
+#define WTABSIZE 32
+
+//
+// timing: timer1 interrupts AUDIO_RATE times a second.  each interrupt (a "tick") plays one
+// sample, and every ROW_TICKS ticks the next display row is lit.  the timer period, tempo,
+// envelope and display timing below are all worked out from F_CPU and AUDIO_RATE, so a board
+// can run at another clock (or sample rate) without the tempo or refresh rate changing.
+//
+#ifndef F_CPU
+#error "F_CPU isn't defined (see F_CPU in Makefile.txt)"
+#endif
+
+// AUDIO_RATE is set in the Makefile.  the presets are 8000, 10000, 16000 and 20000: the ISR
+// time goes down with the rate (10000 is half of 20000), and so does the sound quality.
+// the note table (NoteTab), tempo and envelope timing are worked out for any rate, and the
+// display refresh doesn't change.  (the rate must be a multiple of 1000, see below)
+//
+#ifndef AUDIO_RATE
+#define AUDIO_RATE		20000UL		// ticks per second
+#endif
+
+#define ROW_RATE		1000UL		// display rows per second (10 rows make a 100Hz display cycle)
+
+#define TIMER1_PRESCALE	8
+#define TIMER1_TOP		(F_CPU / TIMER1_PRESCALE / AUDIO_RATE - 1)		// (see start_timer1())
+
+#define MIN_TICK_CYCLES	400			// CPU cycles the ISR needs per tick (the 8mhz, 20khz case)
+
+#if (F_CPU % (TIMER1_PRESCALE * AUDIO_RATE)) != 0
+#error "AUDIO_RATE must divide F_CPU/8 exactly, or pitches and tempos would be off"
+#endif
+#if (F_CPU / AUDIO_RATE) < MIN_TICK_CYCLES
+#error "F_CPU is too slow for AUDIO_RATE (the ISR wouldn't finish before the next tick)"
+#endif
+#if TIMER1_TOP > 0xffff
+#error "AUDIO_RATE is too low for F_CPU (timer1 can't count that far)"
+#endif
+#if (AUDIO_RATE % ROW_RATE) != 0 || (AUDIO_RATE / ROW_RATE) > 255
+#error "AUDIO_RATE must be a multiple of 1000, and at most 255000"
+#endif
+
+#define TEMPOCONST 		(AUDIO_RATE * 60)			// ticks in a minute
+
+#define DEFAULTTEMPO	120							// default tempo in BPM (usually 75)
+
+#define MINTEMPO		(TEMPOCONST / (12 * 0xffffUL) + 1)	// slowest tempo that keeps TempoPeriod within 16 bits
+
+//
+// durations (e.g. N_QUARTER) are counted in units of 1/48 of a whole note, so a beat is 12 units.
+// this is the number of ticks in one unit at a given tempo.  (see settempo())
+//
+#define TEMPOPERIOD(bpm)	(uint16_t)(TEMPOCONST / ((uint16_t)(bpm) * 12))
+
+#define TICKS_PER_MS	(AUDIO_RATE / 1000)		// ticks in 1ms (20 at 20khz)
+
+// display timing: each of the 10 display rows (5 green, then 5 red) is lit for ROW_TICKS ticks
+#define ROW_TICKS		(AUDIO_RATE / ROW_RATE)
+#define CYCLE_TICKS		(10 * ROW_TICKS)	// ticks in a display cycle (10ms)
+
+// after row 9, the display is dark for SCAN_TICKS ticks while the switches are read.
+// (this comes out of row 9's time, so the display cycle is still CYCLE_TICKS)
+#define SCAN_PHASE		10					// value of CurRow for it (see timer1_tick())
+#define SCAN_TICKS		1
+
+// free RAM is filled with this at startup, so stack_headroom() can see how deep the stack has been
+#define STACK_PAINT		0xc5
+
+#define NOTE_SEP (AUDIO_RATE / 100)	// length of small pause (10ms) at end of each note (to differentiate each new note)
+								// note: this comes out of the note's last unit, so it must be shorter than
+								//	TEMPOPERIOD(255)
+
+
+
+// peak value in the wavetables, and the PWM "TOP" they are played against (see start_timer1())
+#define WT_MAX			49
+#define PWM_TOP			TIMER1_TOP
+
+//
+// volume scaled wavetables
+//
+// each wavetable is kept (in flash) as WT_LEVELS-1 copies, scaled to levels 1 to WT_LEVELS-1
+// (level 0 is silence, and is never rendered).  so the ISR never multiplies: envelope_tick()
+// picks a row for a voice's level, and each sample is then just a table read.
+//
+// the rows are also scaled by MIXNUM/MIXDEN, so that NUM_VOICES voices at full level sum to
+// exactly TOP.  (so the mix doesn't need to be scaled back into the PWM range, or clipped)
+//
+// the scale is a fraction of TOP, so loudness is the same at every AUDIO_RATE.  one voice on
+// its own peaks at 1/NUM_VOICES of TOP - with 3 voices, about 2/3 of the old one voice
+// synthesizer (whose peak was WT_MAX, against a TOP of 99).  that is the price of mixing with
+// no clamp in the ISR.  (below about 7800 Hz, TOP is over 255 and the mix is held to 255,
+// so it gets a bit quieter)
+//
+// WT_SCALED() builds the rows from a list of WTABSIZE values (0 to WT_MAX), e.g.
+//	static const uint8_t MyWtable[WT_LEVELS-1][WTABSIZE] PROGMEM = WT_SCALED(MY_VALUES);
+// where MY_VALUES is a #define of the 32 values, separated by commas.
+// (this is also how custom tables are made, see setcustomwavetable())
+//
+#define WT_LEVELS		16
+
+#if PWM_TOP > 255
+#define MIXNUM			255UL			// (the mix is a byte)
+#else
+#define MIXNUM			PWM_TOP
+#endif
+#define MIXDEN			(NUM_VOICES * WT_MAX)
+
+// value v scaled to level l (rounded)
+#define WT_S(v,l)		(uint8_t)(((uint32_t)(v) * (l) * MIXNUM + ((WT_LEVELS-1) * MIXDEN) / 2) \
+							/ ((WT_LEVELS-1) * MIXDEN))
+
+#define WT_ROW(l, ...)	WT_ROW_(l, __VA_ARGS__)		// (expands the list into separate arguments)
+#define WT_ROW_(l, a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31) \
+	WT_S(a0,l), WT_S(a1,l), WT_S(a2,l), WT_S(a3,l), \
+	WT_S(a4,l), WT_S(a5,l), WT_S(a6,l), WT_S(a7,l), \
+	WT_S(a8,l), WT_S(a9,l), WT_S(a10,l), WT_S(a11,l), \
+	WT_S(a12,l), WT_S(a13,l), WT_S(a14,l), WT_S(a15,l), \
+	WT_S(a16,l), WT_S(a17,l), WT_S(a18,l), WT_S(a19,l), \
+	WT_S(a20,l), WT_S(a21,l), WT_S(a22,l), WT_S(a23,l), \
+	WT_S(a24,l), WT_S(a25,l), WT_S(a26,l), WT_S(a27,l), \
+	WT_S(a28,l), WT_S(a29,l), WT_S(a30,l), WT_S(a31,l)
+
+#define WT_SCALED(...) { \
+	{ WT_ROW(1, __VA_ARGS__) }, \
+	{ WT_ROW(2, __VA_ARGS__) }, \
+	{ WT_ROW(3, __VA_ARGS__) }, \
+	{ WT_ROW(4, __VA_ARGS__) }, \
+	{ WT_ROW(5, __VA_ARGS__) }, \
+	{ WT_ROW(6, __VA_ARGS__) }, \
+	{ WT_ROW(7, __VA_ARGS__) }, \
+	{ WT_ROW(8, __VA_ARGS__) }, \
+	{ WT_ROW(9, __VA_ARGS__) }, \
+	{ WT_ROW(10, __VA_ARGS__) }, \
+	{ WT_ROW(11, __VA_ARGS__) }, \
+	{ WT_ROW(12, __VA_ARGS__) }, \
+	{ WT_ROW(13, __VA_ARGS__) }, \
+	{ WT_ROW(14, __VA_ARGS__) }, \
+	{ WT_ROW(15, __VA_ARGS__) } }
+
+#define WT_TABLESIZE	((WT_LEVELS-1) * WTABSIZE)		// bytes in one scaled table
+
+
+//
+// morphing wavetables  (see setvoicemorph() in miggl.c)
+//
+// a morph is a run of scaled tables in flash, that a voice steps through.  WT_MORPH(k, n, A, B)
+// builds table k of a crossfade from A (k = 0) to B (k = n), where A and B are #defines of
+// WTABSIZE values, as for WT_SCALED().  e.g. a crossfade in 4 steps (5 tables, 2400 bytes):
+//	#define MORPH(k)	WT_MORPH(k, 4, MY_VALUES, MY_OTHER_VALUES)
+//	static const uint8_t MyMorph[5][WT_LEVELS-1][WTABSIZE] PROGMEM =
+//		{ MORPH(0), MORPH(1), MORPH(2), MORPH(3), MORPH(4) };
+//
+#define WT_MIX(a,b,k,n)	(((uint16_t)(a) * ((n) - (k)) + (uint16_t)(b) * (k) + (n) / 2) / (n))
+
+// (WT_MORPH() passes the lists in brackets, and these take them out and expand them)
+#define WT_MROW(l, k, n, A, B)	WT_MROW2(l, k, n, WT_UNBRACKET A, WT_UNBRACKET B)
+#define WT_MROW2(...)			WT_MROW_(__VA_ARGS__)
+#define WT_UNBRACKET(...)		__VA_ARGS__
+#define WT_MROW_(l, k, n, a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15, b16, b17, b18, b19, b20, b21, b22, b23, b24, b25, b26, b27, b28, b29, b30, b31) \
+	WT_S(WT_MIX(a0,b0,k,n),l), WT_S(WT_MIX(a1,b1,k,n),l), WT_S(WT_MIX(a2,b2,k,n),l), WT_S(WT_MIX(a3,b3,k,n),l), \
+	WT_S(WT_MIX(a4,b4,k,n),l), WT_S(WT_MIX(a5,b5,k,n),l), WT_S(WT_MIX(a6,b6,k,n),l), WT_S(WT_MIX(a7,b7,k,n),l), \
+	WT_S(WT_MIX(a8,b8,k,n),l), WT_S(WT_MIX(a9,b9,k,n),l), WT_S(WT_MIX(a10,b10,k,n),l), WT_S(WT_MIX(a11,b11,k,n),l), \
+	WT_S(WT_MIX(a12,b12,k,n),l), WT_S(WT_MIX(a13,b13,k,n),l), WT_S(WT_MIX(a14,b14,k,n),l), WT_S(WT_MIX(a15,b15,k,n),l), \
+	WT_S(WT_MIX(a16,b16,k,n),l), WT_S(WT_MIX(a17,b17,k,n),l), WT_S(WT_MIX(a18,b18,k,n),l), WT_S(WT_MIX(a19,b19,k,n),l), \
+	WT_S(WT_MIX(a20,b20,k,n),l), WT_S(WT_MIX(a21,b21,k,n),l), WT_S(WT_MIX(a22,b22,k,n),l), WT_S(WT_MIX(a23,b23,k,n),l), \
+	WT_S(WT_MIX(a24,b24,k,n),l), WT_S(WT_MIX(a25,b25,k,n),l), WT_S(WT_MIX(a26,b26,k,n),l), WT_S(WT_MIX(a27,b27,k,n),l), \
+	WT_S(WT_MIX(a28,b28,k,n),l), WT_S(WT_MIX(a29,b29,k,n),l), WT_S(WT_MIX(a30,b30,k,n),l), WT_S(WT_MIX(a31,b31,k,n),l)
+
+#define WT_MORPH(k, n, A, B) { \
+	{ WT_MROW(1, k, n, (A), (B)) }, \
+	{ WT_MROW(2, k, n, (A), (B)) }, \
+	{ WT_MROW(3, k, n, (A), (B)) }, \
+	{ WT_MROW(4, k, n, (A), (B)) }, \
+	{ WT_MROW(5, k, n, (A), (B)) }, \
+	{ WT_MROW(6, k, n, (A), (B)) }, \
+	{ WT_MROW(7, k, n, (A), (B)) }, \
+	{ WT_MROW(8, k, n, (A), (B)) }, \
+	{ WT_MROW(9, k, n, (A), (B)) }, \
+	{ WT_MROW(10, k, n, (A), (B)) }, \
+	{ WT_MROW(11, k, n, (A), (B)) }, \
+	{ WT_MROW(12, k, n, (A), (B)) }, \
+	{ WT_MROW(13, k, n, (A), (B)) }, \
+	{ WT_MROW(14, k, n, (A), (B)) }, \
+	{ WT_MROW(15, k, n, (A), (B)) } }
+
+
+//
+// LevelTab[e][v] is envelope level e (0 to WT_LEVELS-1) times volume v (0 to MAX_VOLUME),
+// as a level (0 to WT_LEVELS-1).  (see envelope_tick() and setvolume())
+//
+#define LT_S(e,v)		(uint8_t)(((e) * (v) + MAX_VOLUME/2) / MAX_VOLUME)
+#define LT_ROW(e)	{ LT_S(e,0), LT_S(e,1), LT_S(e,2), LT_S(e,3), LT_S(e,4), LT_S(e,5), LT_S(e,6), LT_S(e,7), LT_S(e,8), LT_S(e,9), LT_S(e,10), LT_S(e,11), LT_S(e,12), LT_S(e,13), LT_S(e,14), LT_S(e,15) }
+
+// bit for the sound effect voice in VoiceMask
+#define SFX_BIT			(0x1 << SFX_VOICE)
+
+
+//
+// optional block-rendered audio (compile with -DAUDIO_FIFO, see DEFS in Makefile).
+// the main loop renders mixed values into a FIFO (see fillaudio()), and the ISR just pops them.
+//
+// AUDIO_FIFO_SIZE is the most audio that is rendered ahead, in ticks (64 ticks is 3.2ms at 20khz).
+// it must be a power of 2, no bigger than 128.
+//
+#ifndef AUDIO_FIFO_SIZE
+#define AUDIO_FIFO_SIZE	64
+#endif
+
+#if (AUDIO_FIFO_SIZE & (AUDIO_FIFO_SIZE-1)) || (AUDIO_FIFO_SIZE > 128)
+#error "AUDIO_FIFO_SIZE must be a power of 2, no bigger than 128"
+#endif
+
+#define AUDIO_BLOCK		16		// fillaudio() renders at least this many ticks at a time
+
+
+//
+// noise (WT_NOISE) comes from a 16-bit galois LFSR.  these taps (16, 14, 13, 11) give the
+// maximum length sequence, 65535 steps.  (see noise_render() in miggl.c)
+//
+#define LFSR_TAPS		0xB400
+#define LFSR_SEED		0xACE1		// (anything but zero)
+
+
+//
+// envelope states (see envelope_tick() in miggl.c)
+//
+#define ENV_OFF			0
+#define ENV_ATTACK		1
+#define ENV_DECAY		2
+#define ENV_SUSTAIN		3
+#define ENV_RELEASE		4
+
+
+//
+// song commands (S_REPEAT, S_CALL) in progress.  (see voice_loadnote() in miggl.c)
+//
+#define SONG_DEPTH		4		// most repeats and calls that can be nested
+#define SONG_MAXCMDS	16		// most song commands in a row before a note (or the song is ended)
+
+struct songframe {
+	uint8_t *ptr;			// start of the repeat, or where to return to after a call
+	uint8_t count;			// repeats left (0 means forever)
+	uint8_t call;			// set for S_CALL
+};
+
+
+//
+// packed songs (see playpackedsong() in miggl.c, and tools/songc.c which makes them).
+//
+// most notes are one byte:  DDD PPPPP
+//	DDD is the duration, as an index into PACK_DURS, or PACK_LITERAL if the duration (in units)
+//	is in a byte after the note.
+//	PPPPP is the note, as the number of half steps from the last note plus PACK_DELTA0
+//	(so -15 to +14), or PACK_REST, or PACK_ESCAPE if the note is in a byte after this one.
+//	the escaped byte can also be N_END (the end of the song), or S_TEMPO followed by the tempo
+//	(for these DDD is ignored, and there is no duration byte).
+//
+// the order is: note byte, escaped note (if any), then duration (if any).
+// the first note is counted from PACK_FIRSTNOTE.
+//
+#define PACK_DURS		N_16TH, N_8TH, N_QUARTER, N_HALF, N_WHOLE, N_8TH_DOT, N_QUARTER_DOT
+#define PACK_LITERAL	7
+#define PACK_DELTA0		15
+#define PACK_REST		30
+#define PACK_ESCAPE		31
+#define PACK_NOTEMASK	0x1f
+#define PACK_DURSHIFT	5
+#define PACK_FIRSTNOTE	N_C4
+
+
+//
+// kinds of song request  (see voice_request() in miggl.c)
+//
+#define SONG_TABLE		0		// song table (playsongvoice())
+#define SONG_PACKED		1		// packed song (playpackedsong())
+#define SONG_TRACKER	2		// tracker order list (playtracker())
+#define SONG_SAMPLE		3		// struct sample (playsample())
+
+
+//
+// the steps that 4 bit DPCM samples add to the last value, for each nibble (0 to 15).
+// (see sample_render() in miggl.c, and tools/samplec.c, which picks them)
+//
+#define DPCM_STEPS		-34, -21, -13, -8, -5, -3, -2, -1, 0, 1, 2, 3, 5, 8, 13, 21
+
+#define SMP_HINIB		0x80		// in smpfmt: the next DPCM sample is in the high nibble
+
+//
+// sample values (0 to 255) scaled to each level, like the wavetable rows.  (see SmpLevel in miggl.c)
+// a row has 16 entries for the high nibble of the value, then 16 for the low nibble, so a value
+// is scaled with two table reads and an add, instead of a multiply in the ISR.
+// (both parts round down, so the sum never goes over the level's peak, WT_S(WT_MAX,l))
+//
+#define SMP_S(v,l)		(uint8_t)(((uint32_t)(v) * WT_MAX * (l) * MIXNUM) \
+							/ (255UL * (WT_LEVELS-1) * MIXDEN))
+#define SMP_ROW(l)		{ \
+	SMP_S(0x00,l), SMP_S(0x10,l), SMP_S(0x20,l), SMP_S(0x30,l), \
+	SMP_S(0x40,l), SMP_S(0x50,l), SMP_S(0x60,l), SMP_S(0x70,l), \
+	SMP_S(0x80,l), SMP_S(0x90,l), SMP_S(0xa0,l), SMP_S(0xb0,l), \
+	SMP_S(0xc0,l), SMP_S(0xd0,l), SMP_S(0xe0,l), SMP_S(0xf0,l), \
+	SMP_S(0,l),  SMP_S(1,l),  SMP_S(2,l),  SMP_S(3,l), \
+	SMP_S(4,l),  SMP_S(5,l),  SMP_S(6,l),  SMP_S(7,l), \
+	SMP_S(8,l),  SMP_S(9,l),  SMP_S(10,l), SMP_S(11,l), \
+	SMP_S(12,l), SMP_S(13,l), SMP_S(14,l), SMP_S(15,l) }
+
+
+//
+// commands queued for a voice by playnote() and playsound().  (see struct voice)
+// CMDQSIZE must be a power of 2.
+//
+#define CMDQSIZE		4
+
+struct audiocmd {
+	uint16_t delta;			// wavetable step for this note (0 for a rest)
+	uint16_t dur;			// duration in units, or in ms if CMD_MS is set (for playsound())
+};
+
+#define CMD_MS			0x8000
+
+
+//
+// per-voice audio state
+//
+// main code never changes a voice directly.  it posts requests, which the ISR picks up:
+//	- playsongvoice() (etc) leaves a song in newsong, and sets songreq.
+//	- playnote() and playsound() add to cmdq (main code only moves cmdhead, the ISR only moves cmdtail).
+//
+// note: phase and delta are 8.8 fixed point numbers (the integer part is the wavetable index,
+//	the fractional part is a number divided by 256).  no interpolation is done between table entries.
+//
+struct voice {
+	uint8_t *songPtr;		// points into this voice's song table (next note/duration pair)
+	struct songframe songstack[SONG_DEPTH];		// repeats and calls in progress
+	uint8_t songdepth;		// entries in songstack
+	int8_t transpose;		// half steps added to each note of the song (see S_TRANSPOSE)
+
+	const struct tracksong *track;	// tracker music this voice is playing (see playtracker())
+	const uint8_t *trkloop;			// start of this voice's order list (in flash)
+	const uint8_t *trkorder;		// next entry in the order list
+	const uint8_t *trkrow;			// next row in the current pattern (in flash)
+	uint8_t trkrowsleft;			// rows left in the current pattern
+
+	const uint8_t *packPtr;		// next byte of the packed song this voice is playing (in flash)
+	uint8_t packnote;			// last note of the packed song
+
+	const uint8_t *wavPtr;	// this voice's wavetable (WT_LEVELS-1 scaled rows, in flash)
+	const uint8_t *wavRow;	// the row of wavPtr for the current level
+	uint16_t phase;			// position in the wavetable (integer part wraps at WTABSIZE)
+	uint16_t delta;			// amount added to phase every tick (from NoteTab)
+	uint8_t dur;			// units (1/48 of a whole note) left in the current note, including this one
+	uint16_t msleft;		// ms left in a note timed in ms (0 if the note is timed by dur)
+	uint8_t noise;			// set if this voice plays noise (WT_NOISE) instead of its wavetable
+	uint16_t lfsr;			// noise shift register
+
+	const uint8_t *morphPtr;	// first table of the morph this voice plays (in flash), see setvoicemorph()
+	uint8_t morphcount;		// tables in the morph (0 if this voice isn't morphing)
+	uint8_t morphstep;		// the table that wavPtr is (0 to morphcount-1)
+	uint8_t morphrate;		// ms per step during a note (0 steps once per note instead)
+	uint8_t morphtimer;		// ms left until the next step
+
+	const uint8_t *smpPtr;	// next byte of the sample this voice is playing (in flash), or NULL
+	uint16_t smpleft;		// samples left to play
+	uint8_t smpfmt;			// SAMPLE_PCM8 or SAMPLE_DPCM4, plus SMP_HINIB
+	uint8_t smpval;			// the current sample value (0 to 255)
+
+	uint8_t envstate;		// envelope state (ENV_ATTACK, etc)
+	uint16_t level;			// envelope level (0 to 0xffff)
+	uint8_t lvl;			// level of wavRow (0 to WT_LEVELS-1), from level and mixvol.  0 is silent
+	uint8_t vol;			// volume (0 to MAX_VOLUME, see setvoicevolume())
+	uint8_t mixvol;			// vol, scaled by the master volume (see setvolume())
+	uint16_t attack;		// envelope steps per 1ms (see setenvelope())
+	uint16_t decay;
+	uint16_t release;
+	uint8_t sustain;		// sustain level (0 to 255)
+
+	const uint8_t *newsong;			// song requested by playsongvoice() (etc), tracker order list, or struct sample
+	uint16_t newdelta;				// phase step for a requested sample
+	uint8_t newkind;				// what newsong is (SONG_TABLE, etc)
+	const struct tracksong *newtrack;	// tracker music requested by playtracker()
+	volatile uint8_t songreq;		// set by playsongvoice(), cleared by ISR when it starts newsong
+	uint8_t songflush;				// cmdhead at the time of the request (older commands are dropped)
+
+	struct audiocmd cmdq[CMDQSIZE];	// notes to play when the current song or note is done
+	volatile uint8_t cmdhead;		// (free running) index of next free entry
+	volatile uint8_t cmdtail;		// (free running) index of next entry to play
+};
+
+
+// XXX fix.. these should be hidden (static) inside miggl.c
+extern uint16_t NoteTab[];
+
+
+//
+// convert standard note value into a "delta" for stepping through the wavetable.
+// standard note values (e.g. N_C4 for C4, middle C) are used in the array passed to playsong().
+//
+// note: we use MIN_NOTE constant here to save bytes in NoteTab table.
+//
+#define GETNOTEDELTA(note)		(NoteTab[note-MIN_NOTE])
+
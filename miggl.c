@@ -1,1147 +1,2582 @@
-/*
- *	miggl.c - Mignonette Game Library, v1.95 (v2.01 should be the release)
- *
- *	author(s): rolf van widenfelt (rolfvw at pizzicato dot com) (c) 2008, 2009 - Some Rights Reserved
- *
- *	author(s): mitch altman (c) 2008, 2009 - Some Rights Reserved
- *
- *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
- *		(attribution, non-commercial, share-alike)
- *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
- *
- *
- *	hardware setup:
- *		- Mignonette v2.0 PROTOTYPE
- *
- *	TODO:
- *
- *	- clean up initialization.. there should be one function miggl_init() or something like that.
- *		clean up global vars that shouldn't be exposed too.
- *
- *	- settempo() NYI
- *
- *	- really need to get rid of 48 entry duration table
- *		(use another counter and only re-calculate the 1/48 entry when tempo changes)
- *
- *	- could move wavetables into program memory (to save RAM)
- *
- *	- (as of may 17) do_audio_isr takes about 40-44% of the ISR's full duty cycle.
- *		the display part takes an additional 12-14%.
- *		tuning opportunity!
- *
- *
- *	revision history:
- *
- *	- jan 28, 2010 - rolf
- *		ensure that TxD pin is set to be a port pin.  (see avrinit())
- *		this is needed because the bootloader seems to turn on the USART.
- *
- *	- jan 23, 2010 - rolf
- *		button handling seems to work!  (but needs some cleanup)
- *
- *	- jan 22, 2010 - rolf
- *		start fixing button handling with events... see "buttonmask"  (e.g. handlebuttons())
- *
- *		also, added Jegge's "(temp & 0x00ff)" fix to do_audio_isr().  (thanks Jegge!!)
- *
- *	- jan 14, 2010 - rolf
- *		continue port to prototype Mig V.2 hardware...
- *		the "hack" to read the switches has changed (diodes flipped), so adjust avrinit() accordingly.
- *		it appears to work!  (much code cleanup still needed though)
- *
- *	- dec 27, 2009 - rolf
- *		port to prototype Mig V.2 hardware.
- *		the main issues are:
- *		- 16mhz clock
- *		- display pins ROW1-ROW7 slightly different (some bit shuffling is now needed)
- *		- new method for detecting button presses (separate IO pins for SW1-SW4 are gone)
- *		- a few other AVR pin changes (these were easily handled in iodefs.h)
- *
- *	- apr 12, 2009 - rolf
- *		add readpixel() function.  up revision number to v0.93.
- *
- *	- may 26, 2008 - rolf
- *		minor comments/cleanup.
- *
- *	- may 24, 2008 - rolf
- *		call this version 0.92.
- *
- *	- may 22, 2008 - rolf
- *		add another octave of notes, C3 to B3.
- *
- *	- may 18, 2008 - rolf
- *		minor cleanup & comments.
- *
- *	- may 17, 2008 - rolf
- *		implement setwavetable() and add WT_SINE and WT_SQUARE choices.
- *		note: each table uses 32 bytes of RAM!
- *
- *		also, try making PWMval not volatile, then examine code gen... (hmmm, no diff).
- *
- *	- may 16, 2008 - rolf
- *		continue hacking audio code... playsong() now seems to work!
- *		the bulk of Mitch's audio ISR code remains intact.
- *
- *	- may 13, 2008 - rolf
- *		attempt to integrate Mitch's audio code!
- *		it looks like some API adjustments are needed in playsong(), etc.
- *		made a separate do_audio_isr() function to keep the code intact.
- *		this will eventually need to be merged into the ISR for efficiency.
- *
- *	- apr 27, 2008 - rolf
- *		release under Creative Commons CC-by-nc-sa license.
- *
- *	- apr 23, 2008 - rolf
- *		trying to add button event code.
- *
- *	- apr 19, 2008 - rolf
- *		add stubs for audio API.
- *
- *	- apr 18, 2008 - rolf
- *		basic gfx functionality works.
- *		now, move more low level functions (like avrinit) into here.
- *
- *	- apr 17, 2008 - rolf
- *		created.
- *
- *
- */
-
-#include <inttypes.h>
-#include <avr/io.h>			/* this takes care of definitions for our specific AVR */
-#include <avr/pgmspace.h>	/* needed for printf_P, etc */
-#include <avr/interrupt.h>	/* for interrupts, ISR macro, etc. */
-#include <stdio.h>			// for sprintf, etc.
-//#include <string.h>			// for strcpy, etc.
-
-#include "uart.h"
-
-// for _delay_us() macro  (note: this gets F_CPU define from uart.h)
-#include <util/delay.h>
-
-#include "mydefs.h"
-#include "iodefs.h"
-
-#include "miggl.h"
-#include "miggl-private.h"
-
-
-
-// global graphics state
-static uint8_t _CurColor = RED;
-
-
-// globals for button handling
-byte ButtonA;
-byte ButtonB;
-byte ButtonC;
-byte ButtonD;
-byte ButtonAEvent;
-byte ButtonBEvent;
-byte ButtonCEvent;
-byte ButtonDEvent;
-
-
-// globals for audio here
-
-// sawtooth wavetable (TOP=49) (updated table from Mitch)
-static uint8_t SawWtable[WTABSIZE] = {
-  0,   2,   3,   5, 
-  6,   8,   9,  11, 
- 13,  14,  16,  17, 
- 19,  21,  22,  24, 
- 25,  27,  28,  30, 
- 32,  33,  35,  36, 
- 38,  40,  41,  43, 
- 44,  46,  47,  49, 
-};
-
-
-// sinewave wavetable (TOP=49)
-static uint8_t SineWtable[WTABSIZE] = {
-  25, 29, 34, 38,
-  42, 45, 47, 49,
-  49, 49, 47, 45,
-  42, 38, 34, 29,
-  25, 20, 15, 11,
-   7,  4,  2,  0,
-   0,  0,  2,  4,
-   7, 11, 15, 20,
-};
-
-// squarewave wavetable (TOP=49)
-static uint8_t SquareWtable[WTABSIZE] = {
-  0,   0,   0,   0, 
-  0,   0,   0,   0, 
-  0,   0,   0,   0, 
-  0,   0,   0,   0, 
- 49,  49,  49,  49, 
- 49,  49,  49,  49, 
- 49,  49,  49,  49, 
- 49,  49,  49,  49, 
-};
-
-
-// globals for display/refresh here:
-
-static volatile uint8_t Rcount = 20;
-
-
-volatile uint8_t Disp[10];		// the display buffer (7 x 5 pixels ==> 10 rows of 7 pixels each, right-justified)
-
-volatile uint8_t		CurRow;		// next display buffer row (of 5) to display
-
-volatile uint8_t 	SwapRelease;	// flag (1 bit)
-volatile uint8_t	SwapCounter;
-uint8_t				SwapInterval;
-
-
-// globals for audio here
-
-//const uint8_t* wavTables[];  // table of addresses of different waveform tables (SINE, SAW, TRIANGLE, SQUARE, WEIRD)
-uint8_t* wavPtr;                    // this points to the currently active waveform
-
-uint16_t Wdur;        // duration for playing notes (these are in units of 50usec) -- initialize for 75 bpm (beats per minute)
-uint16_t Wnote_sep;   // small pause at end of each note (these are in units of 50usec)
-
-uint16_t DurTab[];    // table of durations for notes to play (48 durations)
-
-//extern const uint8_t* songTables[]; // table of addresses of different waveform tables (SINE, SAW, TRIANGLE, SQUARE, WEIRD)
-uint8_t* songPtr;				// this points into to the current song table
-//volatile uint16_t StabPtr;     // song table pointer -- initialized to beginning of table
-
-volatile uint8_t CurNote;         // keeps track of note to play next time through the ISR
-
-volatile uint8_t SongPlayFlag; // song play flag is 0 when not playing a song from song table, 1 while playing a song
-
-//volatile int PWMval;           // this is the value that goes into 0CR1A (initialized to first value in wave table)
-int PWMval;           // this is the value that goes into 0CR1A (initialized to first value in wave table)
-
-// WtabCount acts as a pointer through the wavetable as if there were a continuous wavetable, rather than just 32 discreet bytes
-// WtabDelta is the amount to increment the WtabCount to get the next value from the wavetable
-// fixed point number -- the integer part is as expected, the fractional part is a number divided by 256
-//
-// XXX note: should these be volatile?  -rolf
-//
-struct fixedPtNum WtabDelta;  // with this version of firmware we're limited to values between 1.000 and 1.996 (integ part always = 1)
-struct fixedPtNum WtabCount;
-
-
-//
-// audio portion of timer ISR
-//
-// (based on Mitch's ISR code from mig-testrefresh.c of 5/2/2008)
-//
-//	XXX this should be "static" !
-//
-void do_audio_isr(void)
-{
-    uint8_t WtabVal1;   // two values from the wavetable between which we will interpolate
-    uint8_t WtabVal2;
-    uint16_t Wptr1;     // pointer to first value in wavetable
-    uint16_t Wptr2;     // pointer to second value in wavetable
-    uint16_t temp;
-
-    // The PWM value is loaded into the timer compare register at the beginning of the ISR if we are playing a song.
-    // This PWM value was calculated in the previous pass through the ISR.
-
-    // turn off audio if we have played the last note in the song table in the last pass through the ISR
-    if ( CurNote == N_END ) {                  // if we reached the end of the song table
-        SongPlayFlag = 0;                 // stop playing song when reach end of song table    
-        TCCR1A &= ~_BV(COM1A1);           // turn off audio by turning off compare
-        //CurNote = 0;
-    }
-
-    // if we are playing a song, then calculate the PWM value to play the next time we get into the ISR
-    if (SongPlayFlag) {          // only handle audio if we're playing a song (SongPlayFlag is set by main to start playing audio, and it is cleared by ISR when all events in active song table are completed)
-
-        // if the Note to play is a Rest, then turn the speaker off
-        if ( CurNote == N_REST )
-            TCCR1A &= ~_BV(COM1A1);  // turn off audio by turning off compare
-        // otherwise, start playing the note by putting the PWM value in the timer compare register, and turing on the speaker
-        else {
-            TCCR1A |= _BV(COM1A1);   // make sure audio is turned on by turning on compare reg
-            OCR1A = PWMval;          // set the PWM time to next value (that was calculated on the previous pass through the ISR)
-        }
-
-        // calculate the next PWM value (this value will be used next time we get a timer interrrupt)
-    
-        // first, get the two values from the wavetable that we'll interpolating between
-        Wptr2 = WtabCount.integ + WtabDelta.integ;
-        temp = WtabCount.fract + WtabDelta.fract;
-        if ( temp >= 256) Wptr2 += 1;   // if both fractional parts add to 1 or more, get next byte in wavetable for Val2
-        if ( temp > 0) Wptr2 += 1;      // if there is a fractional part, get next byte in wavetable for Val2
-        Wptr1 = Wptr2 - 1;              // the first value is always the byte before the second value
-        if ( Wptr2 >= WTABSIZE) Wptr2 -= WTABSIZE;  // wrap around to the beginning of the wavetable if we reached the end of it
-        if ( Wptr1 >= WTABSIZE) Wptr1 -= WTABSIZE;  // wrap around to the beginning of the wavetable if we reached the end of it
-        WtabVal2 = wavPtr[Wptr2];       // get the second value from the wavetable
-        WtabVal1 = wavPtr[Wptr1];       // get the first value from the wavetable
-    
-        // increment the Count by the Delta (fixed-point math)
-        WtabCount.integ += WtabDelta.integ;
-        temp = WtabCount.fract + WtabDelta.fract;  // we need to put this value in "temp" since "temp" is an int (16-bit value) and the fract parts of WtabCount and WtabDelta are 8-bit values
-        // if the fractional part became 1 or beyond, then increment the integ part and correct the fractional part
-        if ( temp >= 256 ) {                       // (256 is the equivalent of "1" for the fractional part)
-            WtabCount.integ += 1;
-            temp -= 256;
-        }
-        WtabCount.fract = temp;
-        // if the counter is beyond the end of the table, then wrap it around to the beginning of the table
-        if ( WtabCount.integ >= WTABSIZE) {
-            WtabCount.integ -= WTABSIZE;
-        }
-    
-        // now interpolate between the two values
-        // NOTE: we are limited to WtabDelta between 1.0000 and 1.996 [ i.e. integ=1, fract=(0 to 255) ]
-        // this calculates the following:  
-        //     if WtabVal2>WtabVal1:   PWMval = WtabVal1 + [(WtabVal2 - WtabVal1) * WtabCount]
-        //     if WtabVal2<=WtabVal1:  PWMval = WtabVal1 - [(WtabVal1 - WtabVal2) * WtabCount]
-        if (WtabVal2 > WtabVal1)
-            temp = (WtabVal2 - WtabVal1) * WtabCount.fract;
-        else
-            temp = (WtabVal1 - WtabVal2) * WtabCount.fract;
-        // round up if the fractional part of the result is 128 (80 hex) or more (i.e., "0.5" or more)
-        if ( (temp & 0x00ff) < 0x0080 ) 
-            temp = temp / 256;
-        else
-            temp = (temp / 256) + 1;
-        // update PWMval
-        if (WtabVal2 > WtabVal1) 
-            PWMval = WtabVal1 + temp;
-        else 
-            PWMval = WtabVal1 - temp;
-        if (PWMval < 0) PWMval = 0;    // PWM should never go below zero if the above math is good, but I put this check here just in case
-    
-        // Wdur keeps track of the number of times through the ISR that we play a note (i.e., the duration of the sound)
-        // If the duration is completed for playing this note (i.e., Wdur < 0), then we'll add a short pause after it to separate it from the next note
-        if (Wdur > 0) {                // if the duration count is still above 0, then decrement it
-            Wdur--;
-            
-        } 
-        else {                         // else we have finished playing this note from the wavetable
-            // start a slight pause after the note (to distinguish it from the note to follow)
-            if (Wnote_sep > 0) {                      // we'll keep playing no sound until we've gone through the ISR NOTE_SEP times, making a pause after playing the previously played note
-                Wnote_sep--;    
-                //Disp[8] = 0x40;                     // XXX debug: turn on one pixel
-                DDRB &= ~_BV(1);                      // turn off SPKR (OC1A) port
-            }
-            // if we're done with note separation pause, then set up the next note to play for the next time through the ISR
-            else {
-            	uint16_t tmp;
-				uint8_t note, dur;
-
-                Wnote_sep = NOTE_SEP;                 // reset note separation value
-                DDRB |= _BV(1);                       // turn SPKR (OC1A) port back on
-                //Disp[8] = 0x00;                     // XXX debug: turn off the one pixel
-
-				// next time through the ISR we'll start playing the next note in the song table
-
-				// note: this code is repeated inside playsong() - must match!!
-				note = *songPtr++;
-				tmp = GETNOTEDELTA(note);
-				WtabDelta.integ = (uint8_t)((tmp >> 8) & 0xff);		// high byte
-				WtabDelta.fract = (uint8_t)(tmp & 0xff);			// low byte
-				dur = *songPtr++;
-				CurNote = note;						// set 1st note to play, and
-				Wdur = GETDURATION(dur);   			// its duration.
-            }
-        }
-    }
-}
-
-
-//
-// internal switch status
-// note: bits 0-3 contain most recent switch status (1=pressed, 0=not pressed)
-//
-static uint8_t _buttonmask = 0x0;
-
-static uint8_t _buttoneventmask = 0x0;
-
-//
-//	switch polling algorithm:
-//		you will want to study the schematic too!
-//
-//	steps:
-//	- change pins SW1-SW4 (PC1-PC4) to inputs (internal pullups are not needed)
-//	- bring SWCOM (PB0) high
-//	- poll each of SW1-SW4 (high value means switch is pressed)
-//
-//	- to cleanup, bring SWCOM back low, and change SW1-SW4 back to outputs (all low)
-//
-// note: PC1 is the same pin as GC1_SW1, etc.
-//		it is used here to work with the low level macros (_output_low, _output_high).
-//		if pins are renamed, this code will have to be changed too.
-//
-//
-//	XXX this should be "static" !
-//
-void
-poll_switches()
-{
-	// set ROW1-7 low (to avoid lighting any pixels accidentally when touching GC1-4)
-	PORTD = 0x0;
-
-	// set pins to input (DDRx = 0)
-	_output_low(DDRC,PC1);
-	_output_low(DDRC,PC2);
-	_output_low(DDRC,PC3);
-	_output_low(DDRC,PC4);
-	
-	// force diode common line high
-	output_high(SWCOM);
-	
-	NOP();	// needed? yes!!!
-	
-	uint8_t mask = 0x0;
-
-	if (input_test(GC1)==0) {	// note: switch pins are active high!  (different than Mig V.1)
-		mask &= ~0x1;		// clear bit 0
-	} else {
-		mask |= 0x1;		// set bit 0
-	}
-
-	if (input_test(GC2)==0) {
-		mask &= ~0x2;
-	} else {
-		mask |= 0x2;
-	}
-	
-	if (input_test(GC3)==0) {
-		mask &= ~0x4;
-	} else {
-		mask |= 0x4;
-	}
-	
-	if (input_test(GC4)==0) {
-		mask &= ~0x8;
-	} else {
-		mask |= 0x8;
-	}
-
-	_buttoneventmask |= ~_buttonmask & mask;		// an event is when previous bit is 0, and new bit is 1
-	
-	_buttonmask = mask;
-	
-	
-	// restore
-	output_low(SWCOM);
-	_output_high(DDRC,PC1);
-	_output_high(DDRC,PC2);
-	_output_high(DDRC,PC3);
-	_output_high(DDRC,PC4);
-}
-
-
-ISR(TIMER1_OVF_vect)
-{
-
-	// first, handle audio
-	do_audio_isr();
-
-
-	// next, handle the display
-
-	if (--Rcount == 0) {		// do we display a new row this time?  (only every 20 or so)
-		Rcount = 20;
-
-		//
-		// we display green columns (5) followed by the red columns (5).
-		// each will stay on for "Rcount" ticks (20 ticks is about 1ms).
-		//
-		switch (CurRow) {
-			case 0:
-				output_low(RC5);
-				poll_switches();
-				//PORTD = Disp[0] | 0x80;
-				if (Disp[0] & 0x1) {
-					PORTD = Disp[0] | 0x80;
-				} else {
-					PORTD = Disp[0];
-				}
-				output_high(GC1);
-				break;
-
-			case 1:
-				output_low(GC1);
-				//PORTD = Disp[1] | 0x80;
-				if (Disp[1] & 0x1) {
-					PORTD = Disp[1] | 0x80;
-				} else {
-					PORTD = Disp[1];
-				}
-				output_high(GC2);
-				break;
-
-			case 2:
-				output_low(GC2);
-				//PORTD = Disp[2] | 0x80;
-				if (Disp[2] & 0x1) {
-					PORTD = Disp[2] | 0x80;
-				} else {
-					PORTD = Disp[2];
-				}
-				output_high(GC3);
-				break;
-
-			case 3:
-				output_low(GC3);
-				//PORTD = Disp[3] | 0x80;
-				if (Disp[3] & 0x1) {
-					PORTD = Disp[3] | 0x80;
-				} else {
-					PORTD = Disp[3];
-				}
-				output_high(GC4);
-				break;
-
-			case 4:
-				output_low(GC4);
-				//PORTD = Disp[4] | 0x80;
-				if (Disp[4] & 0x1) {
-					PORTD = Disp[4] | 0x80;
-				} else {
-					PORTD = Disp[4];
-				}
-				output_high(GC5);
-				break;
-
-			case 5:
-				output_low(GC5);
-				//PORTD = Disp[5] | 0x80;
-				if (Disp[5] & 0x1) {
-					PORTD = Disp[5] | 0x80;
-				} else {
-					PORTD = Disp[5];
-				}
-				output_high(RC1);
-				break;
-
-			case 6:
-				output_low(RC1);
-				//PORTD = Disp[6] | 0x80;
-				if (Disp[6] & 0x1) {
-					PORTD = Disp[6] | 0x80;
-				} else {
-					PORTD = Disp[6];
-				}
-				output_high(RC2);
-				break;
-
-			case 7:
-				output_low(RC2);
-				//PORTD = Disp[7] | 0x80;
-				if (Disp[7] & 0x1) {
-					PORTD = Disp[7] | 0x80;
-				} else {
-					PORTD = Disp[7];
-				}
-				output_high(RC3);
-				break;
-
-			case 8:
-				output_low(RC3);
-				//PORTD = Disp[8] | 0x80;
-				if (Disp[8] & 0x1) {
-					PORTD = Disp[8] | 0x80;
-				} else {
-					PORTD = Disp[8];
-				}
-				output_high(RC4);
-				break;
-
-			case 9:
-				output_low(RC4);
-				//PORTD = Disp[9] | 0x80;
-				if (Disp[9] & 0x1) {
-					PORTD = Disp[9] | 0x80;
-				} else {
-					PORTD = Disp[9];
-				}
-				output_high(RC5);
-				break;
-
-		}	// switch
-
-
-		CurRow++;
-		if (CurRow >= 10) {
-			CurRow = 0;
-			if (--SwapCounter == 0) {			// we count down display cycles...
-				SwapCounter = SwapInterval;
-				SwapRelease = 1;				// now mark the end of the display cycle
-			}
-		}
-
-	}
-}
-
-
-//
-//
-//	here, we start timer in "fast PWM" mode 14 (see waveform generation, pg 132 of atmega88 doc).
-//
-//
-void start_timer1(void)
-{
-
-	// initialize ICR1, which sets the "TOP" value for the counter to interrupt and start over
-	// note: value of 50-1 ==> 20khz (assumes 8mhz clock, prescaled by 1/8)
-
-	//ICR1 = 50-1;
-	//OCR1A = 25;
-	
-	// note: value of 100-1 ==> 20khz (assumes 16mhz clock, prescaled by 1/8)
-	ICR1 = 100-1;
-	OCR1A = 50;		// XXX why is this set?  unused?
-
-	//
-	// start timer:
-	// set fast PWM, mode 14
-	// and set prescaler to system clock/8
-	//
-
-	TCCR1A = _BV(COM1A1) | _BV(WGM11);			// note: COM1A1 enables the compare match against OCR1A
-
-	TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);
-
-	TIMSK1 |= _BV(TOIE1);		// enable timer1 overflow interrupt
-	
-}
-
-
-/*
- *
- *	low level init needed for AVR.
- *
- */
-void avrinit(void)
-{
-
-	//cli();	// needed??
-	
-	UCSR0B &= ~_BV(TXEN0);	// disable Tx function in USART0
-							// note: this is off by default, but the bootloader code, which
-							//	may precede this initialization, turns it on.
-
-	// note: these MUST be in sync with actual hardware!  (also see iodefs.h)
-
-	// note: DDR pins are set to "1" to be an output, "0" for input.
-
-	//          76543210
-	//PORTB = 0b00000000;		// initial: set to enable pullups on inputs (or to set outputs high)
-	//DDRB  = 0b00111111;		// outputs: SWCOM (PB0), SPKR (PB1), RC5 (PB2), RC1-RC3 (PB3-PB5); reserved (PB6, PB7)
-	PORTB = 0x00;			// (see above)
-	DDRB  = 0x3F;			// (see above)
-	
-	//          76543210
-	//PORTC = 0b00000000;		// XXX testing (no pullups on GC1-GC4)
-	//DDRC  = 0b11111111;		// XXX
-	//PORTC = 0b00000000;		// initial: pullups on inputs
-	//DDRC  = 0b11111111;		// outputs: RC4 (PC0), GC1-GC5 (PC1-PC5)
-	PORTC = 0x00;		// (see above)
-	DDRC  = 0xFF;		// (see above)
-	
-	//          76543210
-	//PORTD = 0b00000000;		// initial: pullups on inputs
-	//DDRD  = 0b11111110;		// outputs: ROW2-ROW7 (PD1-PD6), ROW1 (PD7); reserved (PD0/RxD)
-
-	PORTD = 0x00;		// (see above)
-	DDRD  = 0xFE;		// (see above)
-
-
-	sei();					// enable interrupts (individual interrupts still need to be enabled)
-}
-
-
-void button_init(void)
-{
-	ButtonA = 0;
-	ButtonB = 0;
-	ButtonC = 0;
-	ButtonD = 0;
-	ButtonAEvent = 0;
-	ButtonBEvent = 0;
-	ButtonCEvent = 0;
-	ButtonDEvent = 0;
-}
-
-
-void poll_buttons(void)
-{
-#ifdef NOTDEF	/* XXX fix later! */
-	// clear the state of a button, if it has been released
-
-	if (ButtonA) {
-		if (!button_pressed(SW1)) {
-			ButtonA = 0;
-		}
-	}
-	if (ButtonB) {
-		if (!button_pressed(SW2)) {
-			ButtonB = 0;
-		}
-	}
-	if (ButtonC) {
-		if (!button_pressed(SW3)) {
-			ButtonC = 0;
-		}
-	}
-	if (ButtonD) {
-		if (!button_pressed(SW4)) {
-			ButtonD = 0;
-		}
-	}
-#endif
-}
-
-
-//
-// this watches for button "events" and performs actions accordingly.
-//
-void handlebuttons(void)
-{
-
-#ifdef NOTDEF	/* XXX fix later! */
-	ButtonA = (_buttonmask & 0x1) ? 1 : 0;
-
-	ButtonB = (_buttonmask & 0x2) ? 1 : 0;
-
-	ButtonC = (_buttonmask & 0x4) ? 1 : 0;
-
-	ButtonD = (_buttonmask & 0x8) ? 1 : 0;
-	
-	ButtonAEvent = (_buttoneventmask & 0x1) ? 1 : 0;
-
-	ButtonBEvent = (_buttoneventmask & 0x2) ? 1 : 0;
-
-	ButtonCEvent = (_buttoneventmask & 0x4) ? 1 : 0;
-
-	ButtonDEvent = (_buttoneventmask & 0x8) ? 1 : 0;
-	
-	// XXX still need to copy _buttoneventmask to "Event" vars
-
-#else
-	// XXX this scheme doesn't need _buttoneventmask!
-
-	if (!ButtonA && (_buttonmask & 0x1)) {
-	
-		ButtonA = 1;
-
-		// action
-		ButtonAEvent = 1;
-
-	} else if (!ButtonB && (_buttonmask & 0x2)) {
-
-		ButtonB = 1;
-	
-		// action
-		ButtonBEvent = 1;
-		
-	} else if (!ButtonC && (_buttonmask & 0x4)) {
-
-		ButtonC = 1;
-	
-		// action
-		ButtonCEvent = 1;
-		
-	} else if (!ButtonD && (_buttonmask & 0x8)) {
-
-		ButtonD = 1;
-	
-		// action
-		ButtonDEvent = 1;
-		
-	} else {
-		//poll_buttons();
-
-		ButtonA = (_buttonmask & 0x1) ? 1 : 0;
-	
-		ButtonB = (_buttonmask & 0x2) ? 1 : 0;
-	
-		ButtonC = (_buttonmask & 0x4) ? 1 : 0;
-	
-		ButtonD = (_buttonmask & 0x8) ? 1 : 0;
-	}
-#endif
-}
-
-
-/*
- *	wait (spin) until display cycle has finished
- *
- */
-void swapbuffers(void)
-{
-	while (!SwapRelease) {		// spin until this flag is set
-		NOP();
-	}
-	NOP();
-	SwapRelease = 0;			// clear flag (for next time)
-}
-
-void initswapbuffers(void)
-{
-	SwapRelease = 0;
-	SwapInterval = 1;
-	SwapCounter = 1;
-}
-
-void swapinterval(uint8_t i)
-{
-	if (i != 0) {
-		SwapInterval = i;
-	}
-}
-
-
-void cleardisplay(void)
-{
-	uint8_t i;
-
-	// initialize display buffer
-
-	for (i = 0; i < 10; i++) {
-		Disp[i] = 0x0;
-	}
-
-	//CurRow = 0;			// XXX needed??
-
-	//Disp[0] = 0x40;		/* XXX debug: turn on just one pixel */
-}
-
-
-//
-// set the current color (RED, GREEN, ...)
-//
-void setcolor(uint8_t c)
-{
-	_CurColor = 0x3 & c;
-}
-
-
-//
-// get the current color (returns it).
-//
-uint8_t getcolor(void)
-{
-	return _CurColor;
-}
-
-//
-// draw a point (single pixel) at coordinates (x y),
-//	using the current color.
-//
-//	note: upper left is (0 0) and lower right is (6 4)
-//
-//
-void drawpoint(uint8_t x, uint8_t y)
-{
-	uint8_t bits;
-
-	if ((x < 7) && (y < 5)) {	// clipping
-		bits = 0x40 >> x;
-		if (_CurColor & 0x1) {	// red plane
-			Disp[y+5] |= bits;
-		} else {
-			Disp[y+5] &= ~bits;
-		}
-		if (_CurColor & 0x2) {	// green plane
-			Disp[y] |= bits;
-		} else {
-			Disp[y] &= ~bits;
-		}
-	}
-}
-
-
-//
-// return the pixel at coordinates (x y).
-//	the value returned is the color.
-//	note: coordinates outside of the screen range will return BLACK (0).
-//
-uint8_t readpixel(uint8_t x, uint8_t y)
-{
-	uint8_t bits;
-	uint8_t value;
-
-	if ((x < 7) && (y < 5)) {	// clipping
-		value = 0;
-		bits = 0x40 >> x;
-		if (Disp[y] & bits) {	// check green plane
-			value |= GREEN;
-		}
-		if (Disp[y+5] & bits) {	// check red plane
-			value |= RED;
-		}
-		return value;
-	} else {
-		return 0;
-	}
-}
-
-
-
-//
-//	draw a filled rectangle from (x1 y1) to (x2 y2)
-//
-//	XXX probably could be optimized more
-//
-void drawfilledrect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
-{
-	uint8_t bits;
-	uint8_t x, y, tmp;
-
-	if ((x1 < 7) && (y1 < 5) && (x2 < 7) && (y2 < 5)) {	// clipping
-		if (x1 > x2) {
-			tmp = x1;
-			x1 = x2;
-			x2 = tmp;
-		}
-		if (y1 > y2) {
-			tmp = y1;
-			y1 = y2;
-			y2 = tmp;
-		}
-		for (y = y1; y <= y2; y++) {
-			for (x = x1; x <= x2; x++) {
-				bits = 0x40 >> x;
-				if (_CurColor & 0x1) {	// red plane
-					Disp[y+5] |= bits;
-				} else {
-					Disp[y+5] &= ~bits;
-				}
-				if (_CurColor & 0x2) {	// green plane
-					Disp[y] |= bits;
-				} else {
-					Disp[y] &= ~bits;
-				}
-			}
-		}
-	}
-}
-
-
-// a simple API for making sounds.
-
-void initaudio(void)
-{
-	// default wavetable (WT_SAWTOOTH)
-	wavPtr = SawWtable;
-	
-	// default tempo
-	//XXX
-	
-	SongPlayFlag = 0;
-	PWMval = wavPtr[0];		// initialize to first entry of table
-}
-
-
-//
-// sets tempo for playnote function.
-// the default tempo is 72 beats per minute.
-//
-void settempo(byte bpm)
-{
-	// XXX NYI !!
-}
-
-
-//
-// wavetables are just arrays of samples that produce waveforms.
-// from the API all tables are just referenced by named constants.
-// WT_SAWTOOTH is the default.
-//
-void setwavetable(byte wtable)
-{
-	if (wtable == WT_SINE) {
-		wavPtr = SineWtable;
-	} else if (wtable == WT_SAWTOOTH) {
-		wavPtr = SawWtable;
-	} else if (wtable == WT_SQUARE) {
-		wavPtr = SquareWtable;
-	}
-}
-
-
-//
-// play a tone with pitch in Hz, and dur in ms.
-// the current wavetable is used.
-//
-void playsound(int pitch, int dur)
-{
-	// XXX NYI !!
-}
-
-
-// play a tone with pitch "note" (uses predefined constants like C4 for middle C) and
-// duration dur (predefined constants like N_QUARTER, etc.)
-// the current wavetable is used.
-//
-// XXX NYI !!
-void playnote(byte note, byte dur)
-{}
-
-
-//
-// R2Nx - this converts a ratio (e.g. 1.000) into a standard note (e.g. a frequency),
-// where "x" is the octave number (e.g. for middle C, x = 4).
-//
-// this is used to build the "note table" needed by the audio code.
-//
-#define R2N3(ratio)		(uint16_t)(ratio*64.0+0.5)	
-
-//
-// convert ratio into "frequency" for audio code in ISR
-//
-#define R2N4(ratio)		(uint16_t)(ratio*128.0+0.5)	
-
-//
-// octave higher than above (saves typing below)
-//
-#define R2N5(ratio)		(uint16_t)(ratio*256.0+0.5)	
-
-//
-// table of "frequencies" for standard piano notes
-//
-// this table converts standard piano notes (e.g. N_C4) into 8.8 fixed point deltas
-//	used in the wavetable synthesis code.
-//
-// note: currently, to make the math simpler, notes are transposed a bit.
-//		for example, C5 is about 625 Hz when it really should be 523.251 Hz.  (off by about 3 half steps)
-//		but, the final pitches should be relatively accurate because they are based on ratios
-//
-// also see GETNOTEDELTA() macro which references NoteTab.
-//
-uint16_t NoteTab[] = {
-R2N3(1.000),	// N_C3 - C3 (1 octave below middle C)
-R2N3(1.059),	// N_CS3
-R2N3(1.122),	// N_D3
-R2N3(1.189),	// N_DS3
-R2N3(1.260),	// N_E3
-R2N3(1.335),	// N_F3  
-R2N3(1.414),	// N_FS3
-R2N3(1.498),	// N_G3
-R2N3(1.587),	// N_GS3
-R2N3(1.682),	// N_A3	- A3 (220 Hz)
-R2N3(1.782),	// N_AS3
-R2N3(1.888),	// N_B3
-
-R2N4(1.000),	// N_C4 - C4 (middle C)
-R2N4(1.059),	// N_CS4
-R2N4(1.122),	// N_D4
-R2N4(1.189),	// N_DS4
-R2N4(1.260),	// N_E4
-R2N4(1.335),	// N_F4  
-R2N4(1.414),	// N_FS4
-R2N4(1.498),	// N_G4
-R2N4(1.587),	// N_GS4
-R2N4(1.682),	// N_A4	- A4 (440 Hz)
-R2N4(1.782),	// N_AS4
-R2N4(1.888),	// N_B4
-
-R2N5(1.000),	// N_C5	- C5 (1 octave above middle C)
-R2N5(1.059),	// N_CS5
-R2N5(1.122),	// N_D5
-R2N5(1.189),	// N_DS5
-R2N5(1.260),	// N_E5
-R2N5(1.335),	// N_F5 
-R2N5(1.414),	// N_FS5
-R2N5(1.498),	// N_G5
-R2N5(1.587),	// N_GS5
-R2N5(1.682),	// N_A5	- A5 (880 Hz)
-R2N5(1.782),	// N_AS5
-R2N5(1.888),	// N_B5
-R2N5(2.000),	// N_C6	- C6 (2 octaves above middle C)
-};
-
-
-//
-// this table converts duration values (1..48) into the
-// actual number of ticks used by the audio code.
-// the table is loaded for a specific tempo (e.g. 75 bpm - beats [aka quarter note] per minute).
-//
-// design note:
-//	by using 48 values, instead of a power of two like 16, we can represent triplets.
-//	a quarter note (1 beat) is 12, an eighth note is 6, and an 8th triplet is 4.
-//
-//
-// note: remember to subtract 1 before indexing this table with a standard duration (1..48)
-//
-// XXX need to fill in ALL entries in this table! 
-//	(just did the common ones, all the 0s are placeholders)
-//
-// also see GETDURATION() macro which references DurTab.
-//
-uint16_t DurTab[48] = {
-0,0,TEMPOBEAT/4,TEMPOBEAT/3,0,TEMPOBEAT/2,
-0,0,0,0,0,TEMPOBEAT,
-0,0,0,0,0,0,
-0,0,0,0,0,TEMPOBEAT*2,
-
-0,0,0,0,0,0,
-0,0,0,0,0,TEMPOBEAT*3,
-0,0,0,0,0,0,
-0,0,0,0,0,TEMPOBEAT*4,
-};
-
-
-//
-// play a song, that is, a sequence of notes and durations.
-// this is passed an array of bytes, which is filled with note/duration pairs,
-// and must end with the byte N_END.
-//
-// XXX do we correctly handle the case where this is called when a song is currently playing?
-//
-void playsong(byte *songtable)
-{
-	uint16_t tmp;
-	uint8_t note, dur;
-
-	if (songtable == NULL) {		// error check
-		return;
-	}
-	
-	SongPlayFlag = 0;				// just in case a song is currently playing
-
-	songPtr = songtable;			// set pointer to the song table array
-
-	note = *songPtr++;
-	if (note != N_END) {
-
-		// note: this code is repeated inside ISR - must match!!
-		tmp = GETNOTEDELTA(note);
-		WtabDelta.integ = (uint8_t)((tmp >> 8) & 0xff);		// high byte
-		WtabDelta.fract = (uint8_t)(tmp & 0xff);			// low byte
-		dur = *songPtr++;
-		CurNote = note;						// set 1st note to play, and
-		Wdur = GETDURATION(dur);   			// its duration.
-
-		WtabCount.integ = 0;				// we will start playing from start of current wavetable
-		WtabCount.fract = 0;
-		PWMval = wavPtr[0];					// initialize to first entry of table
-		SongPlayFlag = 1;					// start playing song
-	}
-}
-
-
-//
-// this returns 1 if audio is playing, 0 otherwise.
-//
-byte isaudioplaying(void)
-{
-	return SongPlayFlag;
-}
-
-
-//
-// this waits until audio (e.g. note or song) is finished, then returns.
-//
-void waitaudio(void)
-{
-	while (SongPlayFlag) {
-		NOP();
-	}
-	
-	return;
-}
+/*
+ *	miggl.c - Mignonette Game Library, v1.95 (v2.01 should be the release)
+ *
+ *	author(s): rolf van widenfelt (rolfvw at pizzicato dot com) (c) 2008, 2009 - Some Rights Reserved
+ *
+ *	author(s): mitch altman (c) 2008, 2009 - Some Rights Reserved
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *
+ *	hardware setup:
+ *		- Mignonette v2.0 PROTOTYPE
+ *
+ *	TODO:
+ *
+ *	- clean up initialization.. there should be one function miggl_init() or something like that.
+ *		clean up global vars that shouldn't be exposed too.
+ *
+ *	- (as of may 17) do_audio_isr takes about 40-44% of the ISR's full duty cycle.
+ *		the display part takes an additional 12-14%.
+ *		tuning opportunity!
+ *
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		multi-voice audio: NUM_VOICES voices, each with its own song, wavetable, envelope and
+ *		volume, are mixed into OCR1A.  per voice, the ISR just steps a 8.8 phase through the
+ *		table (no interpolation), and idle voices are skipped.  the last voice is a sound
+ *		effect slot with priorities, which ducks (or silences) the music while it plays.
+ *		see playsongvoice(), setvoicewavetable() and playsfx().
+ *
+ *		audio is rendered in blocks, one voice at a time (see audio_render()).  with
+ *		AUDIO_FIFO defined, the main loop renders into a FIFO (see fillaudio()) and the ISR
+ *		just pops one value into OCR1A.
+ *
+ *		wavetables are in flash, as 15 copies scaled to each level (with the mix scaling built
+ *		in), so the ISR does no multiplies at all: envelope_tick() picks the row for a voice's
+ *		envelope level and volume.  see setenvelope(), setvolume() and setvoicevolume().
+ *		WT_NOISE clocks a LFSR instead of stepping through a table (see noise_render()), and
+ *		setcustomwavetable() and setvoicemorph() play tables made outside the library with
+ *		WT_SCALED() and WT_MORPH().
+ *
+ *		durations are counted in units (1/48 of a whole note) by a tempo divider shared by all
+ *		voices (see settempo()), so the 48 entry duration table is gone and all durations work.
+ *		songs can repeat, call phrases, transpose, and change tempo and wavetable (see S_REPEAT).
+ *		tracker music (playtracker()) and packed songs (playpackedsong(), compiled from MML or
+ *		RTTTL by tools/songc) run on the same divider.
+ *
+ *		main code never touches voice state: songs, notes and samples are posted to the ISR
+ *		(see audio_post(), audio_docmds()), and notes are queued so several can be played
+ *		without waiting.  playnote() goes by the tempo, and playsound() counts ms.  settings
+ *		that the ISR reads are stored in short ATOMIC_BLOCKs, with any slow work (e.g. divides)
+ *		done first.  initaudio() silences everything, so it can be used to start over.
+ *
+ *		add playsample() and playsfxsample(), which play 8 bit PCM or 4 bit DPCM samples from
+ *		flash (made from WAV files by tools/samplec).  they are scaled to a level with two reads
+ *		from SmpLevel, so they don't multiply either.
+ *
+ *		add drawsprite() and getframe(), for sprites, fonts and animations made from ASCII
+ *		art by tools/assetc.  sprites are already in display format, so drawing one is just
+ *		a shift and two masks per row.
+ *
+ *		the timer period, tempo, envelope and display timing are worked out from F_CPU and
+ *		AUDIO_RATE at compile time (see miggl-private.h), instead of assuming 16mhz and 20khz.
+ *		F_CPU comes from the Makefile (uart.h said 8mhz, so _delay_ms() was off by 2x).
+ *
+ *		avrinit() sets up the ports from the pin definitions in iodefs.h (BOARD_DDRB, etc).
+ *		the switch scan is its own phase of the display cycle, after row 9 (see SCAN_PHASE):
+ *		scan_start() sets it up with whole port writes, and a tick later, poll_switches() reads
+ *		all the switches at once.  this replaces the NOP, and the per pin work.
+ *		do_audio_isr() and poll_switches() are static inline, in the plain C timer ISR.
+ *
+ *		this file also builds on the host (see host/hostsim.h), where host/wavout renders the
+ *		audio to WAV files and checks it against golden outputs ("make check").  swapbuffers()
+ *		and waitaudio() call IDLE() while they wait, so a whole game can run on the host too
+ *		(see host/migemu.c, "make emu").
+ *
+ *		add setreplay(), to replay recorded button presses in place of the switches, and
+ *		getbuttonmask() and framehash() for recording them.  add cpuload() and loadmeter(),
+ *		which show how much of each frame the game uses.
+ *
+ *		add stack_headroom(), to see how close the stack has come to the globals.  it needs
+ *		-DSTACK_CHECK, which paints the free RAM at startup (see stack_paint()); without it,
+ *		it returns 0.  "make ramreport" shows the static side.
+ *
+ *	- jan 28, 2010 - rolf
+ *		ensure that TxD pin is set to be a port pin.  (see avrinit())
+ *		this is needed because the bootloader seems to turn on the USART.
+ *
+ *	- jan 23, 2010 - rolf
+ *		button handling seems to work!  (but needs some cleanup)
+ *
+ *	- jan 22, 2010 - rolf
+ *		start fixing button handling with events... see "buttonmask"  (e.g. handlebuttons())
+ *
+ *		also, added Jegge's "(temp & 0x00ff)" fix to do_audio_isr().  (thanks Jegge!!)
+ *
+ *	- jan 14, 2010 - rolf
+ *		continue port to prototype Mig V.2 hardware...
+ *		the "hack" to read the switches has changed (diodes flipped), so adjust avrinit() accordingly.
+ *		it appears to work!  (much code cleanup still needed though)
+ *
+ *	- dec 27, 2009 - rolf
+ *		port to prototype Mig V.2 hardware.
+ *		the main issues are:
+ *		- 16mhz clock
+ *		- display pins ROW1-ROW7 slightly different (some bit shuffling is now needed)
+ *		- new method for detecting button presses (separate IO pins for SW1-SW4 are gone)
+ *		- a few other AVR pin changes (these were easily handled in iodefs.h)
+ *
+ *	- apr 12, 2009 - rolf
+ *		add readpixel() function.  up revision number to v0.93.
+ *
+ *	- may 26, 2008 - rolf
+ *		minor comments/cleanup.
+ *
+ *	- may 24, 2008 - rolf
+ *		call this version 0.92.
+ *
+ *	- may 22, 2008 - rolf
+ *		add another octave of notes, C3 to B3.
+ *
+ *	- may 18, 2008 - rolf
+ *		minor cleanup & comments.
+ *
+ *	- may 17, 2008 - rolf
+ *		implement setwavetable() and add WT_SINE and WT_SQUARE choices.
+ *		note: each table uses 32 bytes of RAM!
+ *
+ *		also, try making PWMval not volatile, then examine code gen... (hmmm, no diff).
+ *
+ *	- may 16, 2008 - rolf
+ *		continue hacking audio code... playsong() now seems to work!
+ *		the bulk of Mitch's audio ISR code remains intact.
+ *
+ *	- may 13, 2008 - rolf
+ *		attempt to integrate Mitch's audio code!
+ *		it looks like some API adjustments are needed in playsong(), etc.
+ *		made a separate do_audio_isr() function to keep the code intact.
+ *		this will eventually need to be merged into the ISR for efficiency.
+ *
+ *	- apr 27, 2008 - rolf
+ *		release under Creative Commons CC-by-nc-sa license.
+ *
+ *	- apr 23, 2008 - rolf
+ *		trying to add button event code.
+ *
+ *	- apr 19, 2008 - rolf
+ *		add stubs for audio API.
+ *
+ *	- apr 18, 2008 - rolf
+ *		basic gfx functionality works.
+ *		now, move more low level functions (like avrinit) into here.
+ *
+ *	- apr 17, 2008 - rolf
+ *		created.
+ *
+ *
+ */
+
+#include <inttypes.h>
+#include <avr/io.h>			/* this takes care of definitions for our specific AVR */
+#include <avr/pgmspace.h>	/* needed for printf_P, etc */
+#include <avr/interrupt.h>	/* for interrupts, ISR macro, etc. */
+#include <util/atomic.h>		/* for ATOMIC_BLOCK */
+#include <stdio.h>			// for sprintf, etc.
+//#include <string.h>			// for strcpy, etc.
+
+#include "uart.h"
+
+// for _delay_us() macro  (note: this gets F_CPU from the Makefile, or uart.h)
+#include <util/delay.h>
+
+#include "mydefs.h"
+#include "iodefs.h"
+
+#include "miggl.h"
+#include "miggl-private.h"
+
+
+
+// global graphics state
+static uint8_t _CurColor = RED;
+
+
+// globals for button handling
+byte ButtonA;
+byte ButtonB;
+byte ButtonC;
+byte ButtonD;
+byte ButtonAEvent;
+byte ButtonBEvent;
+byte ButtonCEvent;
+byte ButtonDEvent;
+
+
+// globals for audio here
+
+// note: wavetables are in flash, and each one is expanded into WT_LEVELS-1 volume levels
+//	by WT_SCALED() (see miggl-private.h), so each table uses 480 bytes of flash, and no RAM.
+
+// sawtooth wavetable (TOP=49) (updated table from Mitch)
+#define SAW_VALUES \
+  0,   2,   3,   5, \
+  6,   8,   9,  11, \
+ 13,  14,  16,  17, \
+ 19,  21,  22,  24, \
+ 25,  27,  28,  30, \
+ 32,  33,  35,  36, \
+ 38,  40,  41,  43, \
+ 44,  46,  47,  49
+
+static const uint8_t SawWtable[WT_LEVELS-1][WTABSIZE] PROGMEM = WT_SCALED(SAW_VALUES);
+
+
+// sinewave wavetable (TOP=49)
+#define SINE_VALUES \
+  25, 29, 34, 38, \
+  42, 45, 47, 49, \
+  49, 49, 47, 45, \
+  42, 38, 34, 29, \
+  25, 20, 15, 11, \
+   7,  4,  2,  0, \
+   0,  0,  2,  4, \
+   7, 11, 15, 20
+
+static const uint8_t SineWtable[WT_LEVELS-1][WTABSIZE] PROGMEM = WT_SCALED(SINE_VALUES);
+
+// squarewave wavetable (TOP=49)
+#define SQUARE_VALUES \
+  0,   0,   0,   0, \
+  0,   0,   0,   0, \
+  0,   0,   0,   0, \
+  0,   0,   0,   0, \
+ 49,  49,  49,  49, \
+ 49,  49,  49,  49, \
+ 49,  49,  49,  49, \
+ 49,  49,  49,  49
+
+static const uint8_t SquareWtable[WT_LEVELS-1][WTABSIZE] PROGMEM = WT_SCALED(SQUARE_VALUES);
+
+
+// envelope level times volume  (see LT_ROW() in miggl-private.h)
+static const uint8_t LevelTab[WT_LEVELS][MAX_VOLUME+1] PROGMEM = {
+	LT_ROW(0),  LT_ROW(1),  LT_ROW(2),  LT_ROW(3),
+	LT_ROW(4),  LT_ROW(5),  LT_ROW(6),  LT_ROW(7),
+	LT_ROW(8),  LT_ROW(9),  LT_ROW(10), LT_ROW(11),
+	LT_ROW(12), LT_ROW(13), LT_ROW(14), LT_ROW(15),
+};
+
+
+// globals for display/refresh here:
+
+static volatile uint8_t Rcount = ROW_TICKS;
+
+
+volatile uint8_t Disp[10];		// the display buffer (7 x 5 pixels ==> 10 rows of 7 pixels each, right-justified)
+
+volatile uint8_t		CurRow;		// next display row (0-9) to light, or SCAN_PHASE
+
+volatile uint8_t 	SwapRelease;	// flag (1 bit)
+volatile uint8_t	SwapCounter;
+uint8_t				SwapInterval;
+
+static uint8_t		CpuLoad;		// percent of the last frame that the game was busy (see cpuload())
+static uint8_t		LoadMeter;		// LOADMETER_OFF, etc
+
+
+// globals for audio here
+
+struct voice Voice[NUM_VOICES];		// state of each voice (see miggl-private.h)
+
+volatile uint8_t VoiceMask;		// bit n is set while voice n is playing a song (cleared by ISR at end of song)
+
+uint8_t PWMval;					// value for OCR1A, mixed on the previous pass through the ISR (0 turns speaker off)
+
+#ifdef AUDIO_FIFO
+static uint8_t AudioFifo[AUDIO_FIFO_SIZE];	// mixed values, rendered by fillaudio() and popped by the ISR
+static volatile uint8_t AudioFifoHead;		// (free running) index of next value to render
+static volatile uint8_t AudioFifoTail;		// (free running) index of next value for the ISR
+static volatile uint8_t AudioBusy;			// set while fillaudio() is rendering
+#endif
+
+volatile uint8_t AudioCmd;		// count of requests posted by main code (see audio_post())
+static uint8_t AudioCmdSeen;	// value of AudioCmd when the ISR last looked at the requests
+
+// these three are never 0, or audio_render() would make no progress.  they start out as
+// initaudio() sets them, in case the timer ISR runs first.
+uint16_t TempoPeriod = TEMPOPERIOD(DEFAULTTEMPO);	// ticks per unit (1/48 of a whole note) at the current tempo (see settempo())
+uint16_t TempoCount = TEMPOPERIOD(DEFAULTTEMPO);	// ticks left in the current unit
+
+uint8_t EnvCount = TICKS_PER_MS;	// ticks left until the next envelope update (see envelope_tick())
+
+uint8_t MasterVolume = MAX_VOLUME;	// (see setvolume())
+
+uint8_t SfxMode = SFX_DUCK;		// how music is mixed under a sound effect (see setsfxmode())
+static uint8_t SfxPriority;		// priority of the sound effect playing on SFX_VOICE (only used by playsfx())
+
+static byte **SongPhrases;		// phrases for S_CALL (see setsongphrases())
+
+static const uint8_t *CustomWtable[NUM_CUSTOM_WT];	// WT_CUSTOM, etc (see setcustomwavetable())
+
+static const uint8_t PackDur[] PROGMEM = { PACK_DURS };	// durations of packed notes
+
+static const int8_t DpcmStep[16] PROGMEM = { DPCM_STEPS };		// (see sample_render())
+
+// sample values scaled to each level (row 0 is silence)  (see SMP_ROW() in miggl-private.h)
+static const uint8_t SmpLevel[WT_LEVELS][32] PROGMEM = {
+	SMP_ROW(0),  SMP_ROW(1),  SMP_ROW(2),  SMP_ROW(3),
+	SMP_ROW(4),  SMP_ROW(5),  SMP_ROW(6),  SMP_ROW(7),
+	SMP_ROW(8),  SMP_ROW(9),  SMP_ROW(10), SMP_ROW(11),
+	SMP_ROW(12), SMP_ROW(13), SMP_ROW(14), SMP_ROW(15),
+};
+
+
+static const uint8_t *getwavetable(byte wtable);
+
+
+//
+// start (or stop) the sound of a note.  the envelope takes it from there.  (see envelope_tick())
+//
+// a morphing voice starts each note from its first table, or steps to the next table once
+// per note.  (see setvoicemorph())
+//
+static inline void voice_noteon(struct voice *v)
+{
+	v->envstate = ENV_ATTACK;
+	if (v->morphcount) {
+		if (v->morphrate) {
+			v->morphstep = 0;
+			v->morphtimer = v->morphrate;
+			v->wavPtr = v->morphPtr;
+		} else if (v->morphstep != v->morphcount - 1) {
+			if (++v->morphstep != 0) {			// (it starts at 255, so the first note plays table 0)
+				v->wavPtr += WT_TABLESIZE;
+			}
+		}
+	}
+}
+
+static inline void voice_noteoff(struct voice *v)
+{
+	if (v->envstate != ENV_OFF) {
+		v->envstate = ENV_RELEASE;
+	}
+}
+
+
+//
+// at the end of a song table, return from the innermost S_CALL (dropping any repeats
+// left open inside it).  returns 0 if there was no call, so this is the end of the song.
+//
+static uint8_t voice_return(struct voice *v)
+{
+	struct songframe *f;
+
+	while (v->songdepth) {
+		f = &v->songstack[--v->songdepth];
+		if (f->call) {
+			v->songPtr = f->ptr;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+//
+// fetch the next note/duration pair from a voice's song table, carrying out any
+// song commands (S_REPEAT, etc) on the way.
+// returns 0 (and leaves the voice alone) if we reached the end of the song table.
+//
+// note: this only happens at note boundaries, so song commands cost nothing per tick.
+//	if there are more than SONG_MAXCMDS commands before the next note (e.g. an empty
+//	"forever" repeat), the song is ended rather than hanging the ISR.
+//
+static uint8_t voice_loadnote(struct voice *v)
+{
+	struct songframe *f;
+	const uint8_t *wp;
+	uint8_t note, arg;
+	int16_t n;
+	uint8_t i;
+
+	for (i = 0; i < SONG_MAXCMDS; i++) {
+		note = v->songPtr[0];
+		if (note == N_END) {
+			if (voice_return(v)) {
+				continue;
+			}
+			return 0;
+		}
+		arg = v->songPtr[1];
+		v->songPtr += 2;
+
+		switch (note) {
+			case S_REPEAT:
+				if (v->songdepth < SONG_DEPTH) {
+					f = &v->songstack[v->songdepth++];
+					f->ptr = v->songPtr;
+					f->count = arg;
+					f->call = 0;
+				}
+				break;
+
+			case S_ENDREPEAT:
+				if (v->songdepth) {
+					f = &v->songstack[v->songdepth-1];
+					if (!f->call) {
+						if ((f->count == 0) || (--f->count != 0)) {
+							v->songPtr = f->ptr;		// go around again
+						} else {
+							v->songdepth--;
+						}
+					}
+				}
+				break;
+
+			case S_CALL:
+				if ((SongPhrases != NULL) && (v->songdepth < SONG_DEPTH)) {
+					f = &v->songstack[v->songdepth++];
+					f->ptr = v->songPtr;
+					f->call = 1;
+					v->songPtr = SongPhrases[arg];
+				}
+				break;
+
+			case S_TRANSPOSE:
+				v->transpose = (int8_t)arg;
+				break;
+
+			case S_TEMPO:				// (this note's first unit is at the new tempo too)
+				TempoPeriod = TempoCount = TEMPOPERIOD((arg < MINTEMPO) ? MINTEMPO : arg);
+				break;
+
+			case S_WAVE:
+				wp = getwavetable(arg);
+				if (wp != NULL) {
+					v->wavPtr = wp;
+					v->noise = (arg == WT_NOISE);
+					v->morphcount = v->morphrate = 0;
+				}
+				break;
+
+			case N_REST:
+				voice_noteoff(v);
+				v->dur = (arg != 0) ? arg : 1;
+				return 1;
+
+			default:
+				n = (int16_t)note + v->transpose;
+				while (n < MIN_NOTE) {			// (move out of range notes by octaves)
+					n += 12;
+				}
+				while (n > MAX_NOTE) {
+					n -= 12;
+				}
+				v->delta = GETNOTEDELTA(n);
+				voice_noteon(v);
+				v->dur = (arg != 0) ? arg : 1;		// (a zero duration would wrap around)
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+//
+// make sure a tracker voice's trkrow points at its next row, moving on to the next pattern
+// in its order list if needed.  returns 0 at the end of the order list.
+//
+static uint8_t track_nextpattern(struct voice *v)
+{
+	uint8_t pat;
+
+	if (v->trkrowsleft) {
+		return 1;
+	}
+
+	pat = pgm_read_byte(v->trkorder);
+	if (pat == TRK_LOOP) {
+		v->trkorder = v->trkloop;
+		pat = pgm_read_byte(v->trkorder);
+	}
+	if ((pat == TRK_END) || (pat == TRK_LOOP)) {
+		return 0;
+	}
+	v->trkorder++;
+
+	v->trkrow = v->track->patterns + (uint16_t)pat * v->track->rows;
+	v->trkrowsleft = v->track->rows;
+	return 1;
+}
+
+
+//
+// fetch the next note from a tracker voice's patterns.  the note lasts one row, plus one
+// for each T_HOLD row after it (even into the next pattern), so a voice only does this when
+// something changes.  returns 0 (and leaves the voice alone) at the end of its order list.
+//
+// note: rows all have the same duration, so the tracks stay in step.
+//
+static uint8_t track_loadnote(struct voice *v)
+{
+	uint8_t note, rowdur, dur;
+
+	if (!track_nextpattern(v)) {
+		return 0;
+	}
+	note = pgm_read_byte(v->trkrow++);
+	v->trkrowsleft--;
+
+	rowdur = v->track->rowdur;
+	dur = rowdur;
+	while ((dur <= 255 - rowdur) && track_nextpattern(v) && (pgm_read_byte(v->trkrow) == T_HOLD)) {
+		v->trkrow++;
+		v->trkrowsleft--;
+		dur += rowdur;
+	}
+
+	if (note == N_REST) {
+		voice_noteoff(v);
+	} else if (note != T_HOLD) {		// (a hold here carries on whatever was there before)
+		v->delta = GETNOTEDELTA(note);
+		voice_noteon(v);
+	}
+	v->dur = (dur != 0) ? dur : 1;
+
+	return 1;
+}
+
+
+//
+// fetch the next note from a voice's packed song.  (see PACK_DURS in miggl-private.h)
+// returns 0 (and leaves the voice alone) at the end of the song.
+//
+static uint8_t pack_loadnote(struct voice *v)
+{
+	const uint8_t *p;
+	uint8_t b, note, dur, i;
+
+	p = v->packPtr;
+	for (i = 0; i < SONG_MAXCMDS; i++) {
+		b = pgm_read_byte(p++);
+		note = b & PACK_NOTEMASK;
+		if (note == PACK_ESCAPE) {
+			note = pgm_read_byte(p++);
+			if (note == N_END) {
+				return 0;			// (packPtr stays on the end)
+			} else if (note == S_TEMPO) {
+				note = pgm_read_byte(p++);
+				TempoPeriod = TempoCount = TEMPOPERIOD((note < MINTEMPO) ? MINTEMPO : note);
+				continue;
+			}
+		} else if (note == PACK_REST) {
+			note = N_REST;
+		} else {
+			note = v->packnote + note - PACK_DELTA0;
+		}
+
+		b >>= PACK_DURSHIFT;
+		dur = (b == PACK_LITERAL) ? pgm_read_byte(p++) : pgm_read_byte(&PackDur[b]);
+		v->packPtr = p;
+
+		if (note == N_REST) {
+			voice_noteoff(v);
+		} else {
+			v->packnote = note;
+			v->delta = GETNOTEDELTA(note);
+			voice_noteon(v);
+		}
+		v->dur = (dur != 0) ? dur : 1;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+//
+// fetch the next note of whatever song (song table, packed song or tracker) a voice is playing.
+// returns 0 if there is none.
+//
+static uint8_t voice_loadsong(struct voice *v)
+{
+	if (v->songPtr != NULL) {
+		return voice_loadnote(v);
+	} else if (v->packPtr != NULL) {
+		return pack_loadnote(v);
+	} else if (v->track != NULL) {
+		return track_loadnote(v);
+	}
+	return 0;
+}
+
+
+//
+// move a voice on to its next note: from its song, or else from its command queue.
+// returns 0 if there is nothing more to play.
+//
+static uint8_t voice_next(struct voice *v)
+{
+	struct audiocmd *cmd;
+
+	v->msleft = 0;
+	if (voice_loadsong(v)) {
+		return 1;
+	}
+
+	if (v->cmdtail != v->cmdhead) {
+		cmd = &v->cmdq[v->cmdtail & (CMDQSIZE-1)];
+		v->delta = cmd->delta;
+		if (cmd->delta != 0) {
+			voice_noteon(v);
+		} else {
+			voice_noteoff(v);
+		}
+		if (cmd->dur & CMD_MS) {		// (counted down by envelope_tick(), dur just says it's playing)
+			v->msleft = cmd->dur & ~CMD_MS;
+			v->dur = 1;
+		} else {
+			v->dur = cmd->dur;
+		}
+		v->cmdtail++;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+//
+// start a sample on a voice (see playsample()).
+//
+// a sample isn't timed by the tempo (dur is 0), and skips the envelope: it plays at full
+// level (times the voice's volume) until it ends.  (see sample_render())
+// at volume 0 it is still stepped through, silently, so it ends on time.
+//
+static inline void sample_start(struct voice *v, const struct sample *s)
+{
+	v->smpPtr = s->data;
+	v->smpleft = s->length;
+	v->smpfmt = s->format;
+	v->smpval = 128;
+	v->delta = v->newdelta;
+	v->dur = 0;
+	v->level = 0xffff;
+	v->envstate = ENV_SUSTAIN;
+	v->lvl = pgm_read_byte(&LevelTab[WT_LEVELS-1][v->mixvol]);
+}
+
+
+//
+// pick up requests posted by main code.  (see audio_post() and playsongvoice())
+//
+// a new song replaces whatever the voice was doing right away (dropping notes queued before it),
+// but queued notes only start when the voice is idle, or just releasing its last note.
+// (otherwise voice_next() gets them when the current note ends, or envelope_tick() when
+// the current sample ends)
+//
+static inline void audio_docmds(void)
+{
+	struct voice *v;
+	uint8_t bit;
+
+	if (AudioCmd == AudioCmdSeen) {			// nothing new
+		return;
+	}
+	AudioCmdSeen = AudioCmd;
+
+	for (v = Voice, bit = 0x1; v < &Voice[NUM_VOICES]; v++, bit <<= 1) {
+		if (v->songreq) {
+			v->songreq = 0;
+			v->cmdtail = v->songflush;
+			v->songPtr = NULL;
+			v->packPtr = NULL;
+			v->track = NULL;
+			v->smpPtr = NULL;
+			v->msleft = 0;
+			if (v->newkind == SONG_TABLE) {
+				v->songPtr = (uint8_t *)v->newsong;
+				v->songdepth = 0;
+				v->transpose = 0;
+			} else if (v->newkind == SONG_PACKED) {
+				v->packPtr = v->newsong;
+				v->packnote = PACK_FIRSTNOTE;
+			} else if (v->newkind == SONG_TRACKER) {
+				v->track = v->newtrack;
+				v->trkloop = v->trkorder = v->newsong;
+				v->trkrowsleft = 0;
+			}
+			if (VoiceMask == 0) {			// nothing else is playing, so start on a whole unit
+				TempoCount = TempoPeriod;
+			}
+			v->phase = 0;					// we will start playing from start of the wavetable
+			v->level = 0;
+			if (v->newkind == SONG_SAMPLE) {
+				sample_start(v, (const struct sample *)v->newsong);
+				VoiceMask |= bit;
+			} else if (voice_loadsong(v)) {
+				VoiceMask |= bit;
+			} else {
+				VoiceMask &= ~bit;
+			}
+		} else if ((((VoiceMask & bit) == 0) || ((v->dur == 0) && (v->smpPtr == NULL)))
+				&& (v->cmdtail != v->cmdhead)) {
+			if (VoiceMask == 0) {
+				TempoCount = TempoPeriod;
+			}
+			v->songPtr = NULL;
+			v->packPtr = NULL;
+			v->track = NULL;
+			v->smpPtr = NULL;
+			voice_next(v);
+			VoiceMask |= bit;
+		}
+	}
+}
+
+
+//
+// tempo events - these happen at most twice per unit (1/48 of a whole note), not per tick.
+//
+//	at NOTE_SEP ticks before the end of a unit, notes in their last unit stop sounding.
+//	(this is the small pause that separates each note from the next one)
+//
+//	at the end of a unit, each voice counts down its note, and moves on to its next one.
+//	a voice with nothing more to play is left with dur = 0, and ends once its note is released.
+//
+//	(notes timed in ms, from playsound(), are left alone here - see envelope_tick())
+//
+static void tempo_notesep(void)
+{
+	struct voice *v;
+
+	for (v = Voice; v < &Voice[NUM_VOICES]; v++) {
+		if ((v->dur == 1) && (v->msleft == 0)) {
+			voice_noteoff(v);
+		}
+	}
+}
+
+static void tempo_unit(void)
+{
+	struct voice *v;
+	uint8_t bit;
+
+	for (v = Voice, bit = 0x1; v < &Voice[NUM_VOICES]; v++, bit <<= 1) {
+		if ((VoiceMask & bit) && (v->dur != 0) && (v->msleft == 0) && (--v->dur == 0)) {
+			if (!voice_next(v)) {			// set up the next note, or let this one fade out
+				voice_noteoff(v);
+			}
+		}
+	}
+}
+
+
+//
+// envelope (ADSR) update - this happens every 1ms (TICKS_PER_MS ticks), not every tick.
+//
+// each voice's level (16 bits) rises to full at its attack rate, falls to its sustain level,
+// and then falls to 0 at its release rate once the note is off.  the top 4 bits of the level,
+// times the voice's volume (mixvol), pick the row of its wavetable that is played (wavRow).
+//
+// a voice that has nothing more to play (dur = 0) ends when its level reaches 0.
+//
+// notes timed in ms (msleft, see playsound()) are counted down here too.  like the tempo
+// events, the note is released just before its end (here, for its last ms).
+//
+static void envelope_tick(void)
+{
+	struct voice *v;
+	uint8_t bit;
+	uint16_t target;
+	uint8_t lvl;
+
+	for (v = Voice, bit = 0x1; v < &Voice[NUM_VOICES]; v++, bit <<= 1) {
+		if ((VoiceMask & bit) == 0) {
+			continue;
+		}
+
+		switch (v->envstate) {
+			case ENV_ATTACK:
+				if (v->level >= 0xffff - v->attack) {
+					v->level = 0xffff;
+					v->envstate = ENV_DECAY;
+				} else {
+					v->level += v->attack;
+				}
+				break;
+
+			case ENV_DECAY:
+				target = ((uint16_t)v->sustain << 8) | v->sustain;
+				if (v->level - target <= v->decay) {		// (level is never below target here)
+					v->level = target;
+					v->envstate = ENV_SUSTAIN;
+				} else {
+					v->level -= v->decay;
+				}
+				break;
+
+			case ENV_RELEASE:
+				if (v->level <= v->release) {
+					v->level = 0;
+					v->envstate = ENV_OFF;
+				} else {
+					v->level -= v->release;
+				}
+				break;
+
+			case ENV_OFF:
+				if (v->dur == 0) {				// nothing more to play...
+					if ((v->cmdtail != v->cmdhead) && voice_next(v)) {
+						break;					// ...but notes were queued behind a sample
+					}
+					VoiceMask &= ~bit;
+				}
+				break;
+		}
+
+		if (v->msleft && (--v->msleft <= 1)) {
+			if (v->msleft) {
+				voice_noteoff(v);
+			} else {
+				v->dur = 0;
+				if (!voice_next(v)) {
+					voice_noteoff(v);
+				}
+			}
+		}
+
+		// a morph during the note moves on a table every morphrate ms (see setvoicemorph())
+		if (v->morphrate && (v->morphstep < v->morphcount - 1) && (--v->morphtimer == 0)) {
+			v->morphtimer = v->morphrate;
+			v->morphstep++;
+			v->wavPtr += WT_TABLESIZE;
+		}
+
+		// no multiply here either - LevelTab does it
+		lvl = pgm_read_byte(&LevelTab[v->level >> 12][v->mixvol]);
+		v->lvl = lvl;
+		if (lvl) {
+			v->wavRow = v->wavPtr + (lvl - 1) * WTABSIZE;
+		}
+	}
+}
+
+
+//
+// render n samples of one (sounding) voice, adding them into buf.
+//
+// the voice's wavetable row (wavRow) is already scaled to its envelope and volume,
+// so each sample is just one read from flash.
+//
+// note: phase, delta and the wavetable pointer stay in registers for the whole loop.
+//
+static inline void voice_render(struct voice *v, uint8_t *buf, uint8_t n)
+{
+	uint16_t phase, delta;
+	const uint8_t *wp;
+
+	phase = v->phase;
+	delta = v->delta;
+	wp = v->wavRow;
+	do {
+		phase += delta;
+		*buf++ += pgm_read_byte(wp + ((phase >> 8) & (WTABSIZE-1)));
+	} while (--n);
+	v->phase = phase;
+}
+
+
+//
+// render n samples of one (sounding) noise voice, adding them into buf.
+//
+// the voice's phase works as a clock divider: each time its integer part moves on, the LFSR
+// takes one step (a shift, and an xor with LFSR_TAPS if a 1 fell out).  the bit that falls out
+// is the output, at the voice's level (the top of its square wave row).
+// so higher notes give "brighter" noise, up to one step per tick.
+//
+static inline void noise_render(struct voice *v, uint8_t *buf, uint8_t n)
+{
+	uint16_t phase, delta, lfsr;
+	uint8_t pos, amp, out;
+
+	phase = v->phase;
+	delta = v->delta;
+	lfsr = v->lfsr;
+	amp = pgm_read_byte(v->wavRow + (WTABSIZE-1));
+	pos = phase >> 8;
+	out = (lfsr & 0x8000) ? amp : 0;		// (the bit that fell out last time)
+	do {
+		phase += delta;
+		if ((uint8_t)(phase >> 8) != pos) {
+			pos = phase >> 8;
+			if (lfsr & 0x1) {
+				lfsr = (lfsr >> 1) ^ LFSR_TAPS;		// (this sets the top bit)
+				out = amp;
+			} else {
+				lfsr >>= 1;
+				out = 0;
+			}
+		}
+		*buf++ += out;
+	} while (--n);
+	v->phase = phase;
+	v->lfsr = lfsr;
+}
+
+
+//
+// render n ticks of one (sounding) sample voice, adding them into buf.
+//
+// like noise_render(), the phase is a clock divider: each time its integer part moves on,
+// the next sample is read (PCM), or decoded (DPCM: one step from DpcmStep added to the last
+// value).  samples can't be kept at every level like the wavetables, so the value (0 to 255)
+// is scaled to the voice's level with SmpLevel: one read for each nibble, and an add.
+//
+// at the end of the sample, the voice goes silent, and envelope_tick() ends it.
+// (at volume 0, lvl is 0, SmpLevel's row is all 0 and this just steps through the sample)
+//
+static inline void sample_render(struct voice *v, uint8_t *buf, uint8_t n)
+{
+	uint16_t phase, delta;
+	const uint8_t *row;
+	uint8_t pos, steps, val, out, b;
+
+	phase = v->phase;
+	delta = v->delta;
+	val = v->smpval;
+	row = SmpLevel[v->lvl];
+	out = pgm_read_byte(row + (val >> 4)) + pgm_read_byte(row + 16 + (val & 0xf));
+	pos = phase >> 8;
+	do {
+		phase += delta;
+		steps = (uint8_t)(phase >> 8) - pos;
+		if (steps) {
+			pos += steps;
+			do {
+				if (v->smpleft == 0) {			// end of the sample
+					v->smpPtr = NULL;
+					v->envstate = ENV_OFF;
+					v->level = 0;
+					v->lvl = 0;
+					row = SmpLevel[0];
+					break;
+				}
+				v->smpleft--;
+				b = pgm_read_byte(v->smpPtr);
+				if ((v->smpfmt & ~SMP_HINIB) == SAMPLE_PCM8) {
+					val = b;
+					v->smpPtr++;
+				} else if (v->smpfmt & SMP_HINIB) {
+					val += pgm_read_byte(&DpcmStep[b >> 4]);
+					v->smpPtr++;
+					v->smpfmt &= ~SMP_HINIB;
+				} else {
+					val += pgm_read_byte(&DpcmStep[b & 0xf]);
+					v->smpfmt |= SMP_HINIB;
+				}
+			} while (--steps);
+			out = pgm_read_byte(row + (val >> 4)) + pgm_read_byte(row + 16 + (val & 0xf));
+		}
+		*buf++ += out;
+	} while (--n);
+	v->phase = phase;
+	v->smpval = val;
+}
+
+
+//
+// render n samples of one voice (tone, noise or sample), adding them into buf.
+//
+static inline void voice_mix(struct voice *v, uint8_t *buf, uint8_t n)
+{
+	if (v->smpPtr != NULL) {
+		sample_render(v, buf, n);
+	} else if (v->noise) {
+		noise_render(v, buf, n);
+	} else {
+		voice_render(v, buf, n);
+	}
+}
+
+
+//
+// render n mixed samples (values for OCR1A, 0 means speaker off) into buf.
+//
+// each playing voice steps through its own wavetable and song table, and the voices are summed.
+// (the wavetables are scaled so the sum always fits the PWM range, see WT_SCALED())
+// to keep this cheap, each voice just adds its delta to its phase and picks the nearest
+// table entry (no interpolation), and voices that aren't sounding are skipped.
+//
+// the block is split wherever a tempo or envelope event falls (see tempo_unit(), envelope_tick()),
+// so note changes and envelopes cost nothing per tick - just counting down TempoCount and EnvCount.
+//
+// the last voice (SFX_VOICE) is for sound effects.  while it plays, the music voices
+// keep running (so they stay in time) but are ducked or silenced.  (see playsfx())
+//
+// new songs and notes from main code are picked up at the start of each block.
+//
+// this is called with n = 1 from the ISR, or with larger blocks from fillaudio() (AUDIO_FIFO).
+//
+static inline void audio_render(uint8_t *buf, uint8_t n)
+{
+	struct voice *v;
+	uint8_t bit;
+	uint8_t i, seg;
+
+	audio_docmds();
+
+	while (n) {
+
+		// how far to the next tempo or envelope event?
+		seg = (EnvCount < n) ? EnvCount : n;
+		if (TempoCount > NOTE_SEP) {
+			if (TempoCount - NOTE_SEP < seg) {
+				seg = TempoCount - NOTE_SEP;
+			}
+		} else if (TempoCount < seg) {
+			seg = TempoCount;
+		}
+
+		for (i = 0; i < seg; i++) {
+			buf[i] = 0;
+		}
+
+		// first, sum the music voices
+		for (v = Voice, bit = 0x1; v < &Voice[SFX_VOICE]; v++, bit <<= 1) {
+			if ((VoiceMask & bit) && (v->lvl || (v->smpPtr != NULL))) {	// skip idle and silent voices (not samples)
+				voice_mix(v, buf, seg);
+			}
+		}
+
+		// then the sound effect voice, if playing, goes on top of the (ducked or silenced) music
+		if (VoiceMask & SFX_BIT) {
+			if (SfxMode == SFX_DUCK) {
+				for (i = 0; i < seg; i++) {
+					buf[i] >>= 1;
+				}
+			} else {
+				for (i = 0; i < seg; i++) {
+					buf[i] = 0;
+				}
+			}
+			v = &Voice[SFX_VOICE];
+			if (v->lvl || (v->smpPtr != NULL)) {
+				voice_mix(v, buf, seg);
+			}
+		}
+
+		buf += seg;
+		n -= seg;
+
+		TempoCount -= seg;
+		if (TempoCount == NOTE_SEP) {
+			tempo_notesep();
+		} else if (TempoCount == 0) {
+			TempoCount = TempoPeriod;
+			tempo_unit();
+		}
+
+		EnvCount -= seg;
+		if (EnvCount == 0) {
+			EnvCount = TICKS_PER_MS;
+			envelope_tick();
+		}
+	}
+}
+
+
+//
+// put a mixed value into OCR1A (0 turns the speaker off)
+//
+static inline void audio_output(uint8_t val)
+{
+	if (val) {
+		TCCR1A |= _BV(COM1A1);		// make sure audio is turned on by turning on compare reg
+		OCR1A = val;
+	} else {
+		TCCR1A &= ~_BV(COM1A1);		// turn off audio by turning off compare
+	}
+}
+
+
+//
+// audio portion of timer ISR
+//
+// (originally based on Mitch's ISR code from mig-testrefresh.c of 5/2/2008)
+//
+// normally, the value rendered on the previous pass goes into OCR1A, then the next one is rendered.
+//
+// with AUDIO_FIFO, the ISR just pops the next value rendered by fillaudio().
+// if the FIFO runs dry, the value is rendered here instead (unless fillaudio() is busy,
+// in which case the last value is held for a tick).
+//
+static inline void do_audio_isr(void)
+{
+#ifdef AUDIO_FIFO
+	uint8_t val;
+
+	if (AudioFifoTail != AudioFifoHead) {
+		val = AudioFifo[AudioFifoTail & (AUDIO_FIFO_SIZE-1)];
+		AudioFifoTail++;
+	} else if (AudioBusy) {			// fillaudio() is about to catch up
+		return;
+	} else if (VoiceMask || (AudioCmd != AudioCmdSeen)) {	// underrun
+		audio_render(&val, 1);
+	} else {						// nothing playing
+		val = 0;
+	}
+	audio_output(val);
+
+#else
+	if ((VoiceMask == 0) && (PWMval == 0) && (AudioCmd == AudioCmdSeen)) {	// nothing playing (and speaker is already off)
+		return;
+	}
+
+	audio_output(PWMval);			// value rendered on the previous pass through the ISR
+	audio_render(&PWMval, 1);
+#endif
+}
+
+
+//
+// render audio into the FIFO, until it is full.  (only with AUDIO_FIFO, otherwise it does nothing)
+//
+// this is called while spinning in swapbuffers() and waitaudio().  games that do a lot of work
+// between calls to swapbuffers() should call it every so often too.
+//
+void fillaudio(void)
+{
+#ifdef AUDIO_FIFO
+	uint8_t head, n;
+
+	if ((VoiceMask == 0) && (AudioCmd == AudioCmdSeen)) {
+		return;
+	}
+
+	AudioBusy = 1;
+
+	// render in blocks of at least AUDIO_BLOCK samples, but never past the end of the array
+	while ((n = AUDIO_FIFO_SIZE - (uint8_t)(AudioFifoHead - AudioFifoTail)) >= AUDIO_BLOCK) {
+		head = AudioFifoHead & (AUDIO_FIFO_SIZE-1);
+		if (n > AUDIO_FIFO_SIZE - head) {
+			n = AUDIO_FIFO_SIZE - head;
+		}
+		audio_render(&AudioFifo[head], n);
+
+		__asm__ volatile("" ::: "memory");		// samples must be stored before the ISR can see them
+		AudioFifoHead += n;
+	}
+
+	AudioBusy = 0;
+#endif
+}
+
+
+//
+// put a row of the display buffer onto the row pins (see ROW_BITS() in iodefs.h)
+//
+static inline void setrow(uint8_t d)
+{
+	ROW_PORT = ROW_BITS(d);
+}
+
+
+//
+// internal switch status
+// note: bits 0-3 contain most recent switch status (1=pressed, 0=not pressed)
+//
+static uint8_t _buttonmask = 0x0;
+
+static uint8_t _buttoneventmask = 0x0;
+
+static const uint8_t *ReplayPtr;		// next pair in the replay table (NULL when not replaying)
+static uint8_t ReplayCount;				// display cycles left in the current pair
+static uint8_t ReplayMask;
+
+//
+//	switch polling algorithm:
+//		you will want to study the schematic too!
+//
+//	the switches are read in a phase of their own, after row 9 (see SCAN_PHASE), with the
+//	display dark.  whole ports are written, since every column is off then anyway.
+//
+//	steps:
+//	- scan_start(): with the rows and columns all off, change pins SW1-SW4 (PC1-PC4) to
+//	  inputs (internal pullups are not needed), and bring SWCOM (PB0) high
+//	- a tick later, poll_switches(): read SW1-SW4 with one read of PINC (high value means
+//	  switch is pressed), then bring SWCOM back low, and change SW1-SW4 back to outputs
+//
+//	(the tick in between gives the pins time to settle, which a NOP used to do)
+//
+// note: SW1-SW4 share pins with GC1-GC4 (see GC1_SW1, SW_PIN, etc in iodefs.h).
+//
+static inline void scan_start(void)
+{
+	// set ROW1-7 low (to avoid lighting any pixels accidentally when touching GC1-4)
+	setrow(0);
+
+	SW_PORT = BOARD_HIGH(PORT_OF(GC1_SW1));						// all columns off
+	SW_DDR = BOARD_OUTPUTS(PORT_OF(GC1_SW1)) & ~SW_MASK;		// SW1-SW4 are inputs
+	PORT_REG(SWCOM) = BOARD_HIGH(PORT_OF(SWCOM)) | PIN_MASK(SWCOM);	// force diode common line high
+}
+
+
+static inline void poll_switches(void)
+{
+	uint8_t mask;
+
+	mask = (SW_PIN >> SW_SHIFT) & 0xf;		// note: switch pins are active high!  (different than Mig V.1)
+
+	// restore
+	PORT_REG(SWCOM) = BOARD_HIGH(PORT_OF(SWCOM));
+	SW_DDR = BOARD_OUTPUTS(PORT_OF(GC1_SW1));
+
+	if (ReplayPtr != NULL) {		// a replay overrides the switches (which are read anyway, to keep the timing)
+		if (ReplayCount == 0) {
+			ReplayCount = pgm_read_byte(ReplayPtr);
+			ReplayMask = pgm_read_byte(ReplayPtr+1);
+			ReplayPtr += 2;
+		}
+		if (ReplayCount == 0) {		// end of the table
+			ReplayPtr = NULL;
+		} else {
+			ReplayCount--;
+			mask = ReplayMask;
+		}
+	}
+
+	_buttoneventmask |= ~_buttonmask & mask;		// an event is when previous bit is 0, and new bit is 1
+	
+	_buttonmask = mask;
+}
+
+
+//
+// the whole timer tick: audio, then (every ROW_TICKS ticks) the next display row.
+//
+// this is the body of the timer ISR.
+//
+static inline void timer1_tick(void)
+{
+
+	// first, handle audio
+	do_audio_isr();
+
+
+	// next, handle the display
+
+	if (--Rcount == 0) {		// do we display a new row this time?  (only every 20 or so)
+		Rcount = ROW_TICKS;
+
+		//
+		// we display green columns (5) followed by the red columns (5).
+		// each will stay on for "Rcount" ticks (ROW_TICKS ticks is 1ms).
+		//
+		switch (CurRow) {
+			case 0:
+				poll_switches();		// (the display is dark, see scan_start())
+				setrow(Disp[0]);
+				output_high(GC1);
+				break;
+
+			case 1:
+				output_low(GC1);
+				setrow(Disp[1]);
+				output_high(GC2);
+				break;
+
+			case 2:
+				output_low(GC2);
+				setrow(Disp[2]);
+				output_high(GC3);
+				break;
+
+			case 3:
+				output_low(GC3);
+				setrow(Disp[3]);
+				output_high(GC4);
+				break;
+
+			case 4:
+				output_low(GC4);
+				setrow(Disp[4]);
+				output_high(GC5);
+				break;
+
+			case 5:
+				output_low(GC5);
+				setrow(Disp[5]);
+				output_high(RC1);
+				break;
+
+			case 6:
+				output_low(RC1);
+				setrow(Disp[6]);
+				output_high(RC2);
+				break;
+
+			case 7:
+				output_low(RC2);
+				setrow(Disp[7]);
+				output_high(RC3);
+				break;
+
+			case 8:
+				output_low(RC3);
+				setrow(Disp[8]);
+				output_high(RC4);
+				break;
+
+			case 9:
+				output_low(RC4);
+				setrow(Disp[9]);
+				output_high(RC5);
+				Rcount = ROW_TICKS - SCAN_TICKS;	// (the switch scan gets the rest)
+				break;
+
+			case SCAN_PHASE:
+				scan_start();					// (this turns off RC5 too)
+				Rcount = SCAN_TICKS;
+				break;
+
+		}	// switch
+
+
+		CurRow++;
+		if (CurRow == SCAN_PHASE) {
+			if (--SwapCounter == 0) {			// we count down display cycles...
+				SwapCounter = SwapInterval;
+				SwapRelease = 1;				// now mark the end of the display cycle
+			}
+		} else if (CurRow > SCAN_PHASE) {
+			CurRow = 0;
+		}
+
+	}
+}
+
+
+ISR(TIMER1_OVF_vect)
+{
+	timer1_tick();
+}
+
+
+//
+//
+//	here, we start timer in "fast PWM" mode 14 (see waveform generation, pg 132 of atmega88 doc).
+//
+//
+void start_timer1(void)
+{
+
+	// initialize ICR1, which sets the "TOP" value for the counter to interrupt and start over
+	// note: this gives AUDIO_RATE interrupts a second (e.g. 100-1 ==> 20khz, with a 16mhz
+	//	clock prescaled by 1/8)
+	ICR1 = TIMER1_TOP;
+	OCR1A = 50;		// XXX why is this set?  unused?
+
+	//
+	// start timer:
+	// set fast PWM, mode 14
+	// and set prescaler to system clock/8
+	//
+
+	TCCR1A = _BV(COM1A1) | _BV(WGM11);			// note: COM1A1 enables the compare match against OCR1A
+
+	TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);
+
+	TIMSK1 |= _BV(TOIE1);		// enable timer1 overflow interrupt
+	
+}
+
+
+//
+// stack painting - the RAM between the globals (_end) and the top of the stack (__stack)
+// is filled with STACK_PAINT before main() starts.  the stack grows down from the top, so
+// stack_headroom() counts how much paint is left at the bottom.
+//
+// this runs in .init1, before the stack pointer is set up and r1 is cleared, so it can't be
+// C code.  (this is the usual avr-libc way to do it)
+//
+// note: it is only built with -DSTACK_CHECK (see DEFS in the Makefile) for now, since it
+//	hasn't been tried on a Mignonette yet.  without it, stack_headroom() doesn't know.
+//
+#if !defined(MIG_HOST) && defined(STACK_CHECK)
+extern uint8_t _end;
+extern uint8_t __stack;
+
+void stack_paint(void) __attribute__ ((naked, used, section (".init1")));
+
+void stack_paint(void)
+{
+	__asm__ volatile (
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n"
+		:: "M" (STACK_PAINT));
+}
+#endif
+
+
+//
+// how many bytes of RAM the stack has never touched (since reset).
+// check this after playing for a while, with all the sounds and effects going, to see how
+// much room is left for more globals.  (a game that uses malloc() will use some of this too)
+// on the host (or without STACK_CHECK) there is no painted stack, so this returns 0: it
+// doesn't know, and that must never look like plenty of room.
+//
+uint16_t stack_headroom(void)
+{
+#if defined(MIG_HOST) || !defined(STACK_CHECK)
+	return 0;
+#else
+	const uint8_t *p;
+	uint16_t n;
+
+	n = 0;
+	for (p = &_end; (p <= &__stack) && (*p == STACK_PAINT); p++) {
+		n++;
+	}
+	return n;
+#endif
+}
+
+
+/*
+ *
+ *	low level init needed for AVR.
+ *
+ */
+void avrinit(void)
+{
+
+	//cli();	// needed??
+	
+	UCSR0B &= ~_BV(TXEN0);	// disable Tx function in USART0
+							// note: this is off by default, but the bootloader code, which
+							//	may precede this initialization, turns it on.
+
+	// the ports are set up from the pin definitions in iodefs.h (see BOARD_OUTPUTS).
+	// note: DDR pins are set to "1" to be an output, "0" for input.
+	//
+	// for the Mig V.2 prototype, that is:
+	//	PORTB = 0x00, DDRB = 0x3F	outputs: SWCOM (PB0), SPKR (PB1), RC5 (PB2), RC1-RC3 (PB3-PB5); reserved (PB6, PB7)
+	//	PORTC = 0x00, DDRC = 0x3F	outputs: RC4 (PC0), GC1-GC5 (PC1-PC5)  (no pullups on GC1-GC4)
+	//	PORTD = 0x00, DDRD = 0xFE	outputs: ROW2-ROW7 (PD1-PD6), ROW1 (PD7); reserved (PD0/RxD)
+
+	PORTB = BOARD_PORTB;
+	DDRB  = BOARD_DDRB;
+	PORTC = BOARD_PORTC;
+	DDRC  = BOARD_DDRC;
+	PORTD = BOARD_PORTD;
+	DDRD  = BOARD_DDRD;
+
+
+	sei();					// enable interrupts (individual interrupts still need to be enabled)
+}
+
+
+//
+// the buttons that were down when the switches were last read (once per display cycle).
+// bit 0 is button A, bit 1 is B, etc.  (handlebuttons() turns these into ButtonA, etc)
+//
+byte getbuttonmask(void)
+{
+	return _buttonmask;
+}
+
+
+//
+// replay button presses from a table in flash, instead of reading the switches.
+// (see "replaying button presses" in miggl.h)
+// the replay starts at the next display cycle, and stops at the end of the table
+// (or with setreplay(NULL)).  a game that starts the same way will then do exactly the same
+// thing every time, which is handy for testing and for timing it before and after a change.
+//
+void setreplay(const byte *table)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (the ISR reads these)
+		ReplayCount = 0;
+		ReplayPtr = table;
+	}
+}
+
+
+byte isreplaying(void)
+{
+	return (ReplayPtr != NULL);
+}
+
+
+//
+// 16-bit hash of the display buffer (CRC-16/CCITT of Disp[]).
+// a replay can log this once per frame to check that a game still draws the same frames.
+//
+uint16_t framehash(void)
+{
+	uint16_t crc;
+	uint8_t i, k;
+
+	crc = 0xffff;
+	for (i = 0; i < 10; i++) {
+		crc ^= (uint16_t)Disp[i] << 8;
+		for (k = 0; k < 8; k++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+
+void button_init(void)
+{
+	ButtonA = 0;
+	ButtonB = 0;
+	ButtonC = 0;
+	ButtonD = 0;
+	ButtonAEvent = 0;
+	ButtonBEvent = 0;
+	ButtonCEvent = 0;
+	ButtonDEvent = 0;
+}
+
+
+void poll_buttons(void)
+{
+#ifdef NOTDEF	/* XXX fix later! */
+	// clear the state of a button, if it has been released
+
+	if (ButtonA) {
+		if (!button_pressed(SW1)) {
+			ButtonA = 0;
+		}
+	}
+	if (ButtonB) {
+		if (!button_pressed(SW2)) {
+			ButtonB = 0;
+		}
+	}
+	if (ButtonC) {
+		if (!button_pressed(SW3)) {
+			ButtonC = 0;
+		}
+	}
+	if (ButtonD) {
+		if (!button_pressed(SW4)) {
+			ButtonD = 0;
+		}
+	}
+#endif
+}
+
+
+//
+// this watches for button "events" and performs actions accordingly.
+//
+void handlebuttons(void)
+{
+
+#ifdef NOTDEF	/* XXX fix later! */
+	ButtonA = (_buttonmask & 0x1) ? 1 : 0;
+
+	ButtonB = (_buttonmask & 0x2) ? 1 : 0;
+
+	ButtonC = (_buttonmask & 0x4) ? 1 : 0;
+
+	ButtonD = (_buttonmask & 0x8) ? 1 : 0;
+	
+	ButtonAEvent = (_buttoneventmask & 0x1) ? 1 : 0;
+
+	ButtonBEvent = (_buttoneventmask & 0x2) ? 1 : 0;
+
+	ButtonCEvent = (_buttoneventmask & 0x4) ? 1 : 0;
+
+	ButtonDEvent = (_buttoneventmask & 0x8) ? 1 : 0;
+	
+	// XXX still need to copy _buttoneventmask to "Event" vars
+
+#else
+	// XXX this scheme doesn't need _buttoneventmask!
+
+	if (!ButtonA && (_buttonmask & 0x1)) {
+	
+		ButtonA = 1;
+
+		// action
+		ButtonAEvent = 1;
+
+	} else if (!ButtonB && (_buttonmask & 0x2)) {
+
+		ButtonB = 1;
+	
+		// action
+		ButtonBEvent = 1;
+		
+	} else if (!ButtonC && (_buttonmask & 0x4)) {
+
+		ButtonC = 1;
+	
+		// action
+		ButtonCEvent = 1;
+		
+	} else if (!ButtonD && (_buttonmask & 0x8)) {
+
+		ButtonD = 1;
+	
+		// action
+		ButtonDEvent = 1;
+		
+	} else {
+		//poll_buttons();
+
+		ButtonA = (_buttonmask & 0x1) ? 1 : 0;
+	
+		ButtonB = (_buttonmask & 0x2) ? 1 : 0;
+	
+		ButtonC = (_buttonmask & 0x4) ? 1 : 0;
+	
+		ButtonD = (_buttonmask & 0x8) ? 1 : 0;
+	}
+#endif
+}
+
+
+//
+// how far the game got into this frame, in percent (100 if it has already ended).
+// the ISR's row counters tell us how many ticks have gone by since SwapRelease was set.
+//
+static uint8_t measureload(void)
+{
+	uint8_t counter, row, rcount, release;
+	uint32_t ticks;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (a consistent set of counters)
+		release = SwapRelease;
+		counter = SwapCounter;
+		row = CurRow;
+		rcount = Rcount;
+	}
+
+	if (release) {				// we're late, the frame is over already
+		return 100;
+	}
+	if (row == SCAN_PHASE) {	// (row 9 is still lit, and is SCAN_TICKS short)
+		row = 0;
+		rcount += SCAN_TICKS;
+	}
+	ticks = (uint32_t)(SwapInterval - counter) * CYCLE_TICKS + row * ROW_TICKS + (ROW_TICKS - rcount);
+	return (uint8_t)(ticks * 100 / ((uint32_t)SwapInterval * CYCLE_TICKS));
+}
+
+
+//
+// draw the load meter over the bottom row (see loadmeter())
+//
+static void drawloadmeter(void)
+{
+	uint8_t bits, n;
+
+	if (LoadMeter == LOADMETER_PIXEL) {
+		bits = 0x1;				// bottom right pixel
+	} else {
+		n = (CpuLoad * 7 + 50) / 100;
+		bits = 0x7f & ~(0x7f >> n);		// n pixels from the left
+		Disp[4] &= ~0x7f;
+		Disp[9] &= ~0x7f;
+	}
+
+	if (CpuLoad < 75) {			// green
+		Disp[4] |= bits;
+		Disp[9] &= ~bits;
+	} else if (CpuLoad < 100) {	// yellow
+		Disp[4] |= bits;
+		Disp[9] |= bits;
+	} else {					// red
+		Disp[4] &= ~bits;
+		Disp[9] |= bits;
+	}
+}
+
+
+/*
+ *	wait (spin) until display cycle has finished
+ *
+ *	this also measures how busy the game is (see cpuload()).
+ */
+void swapbuffers(void)
+{
+	CpuLoad = measureload();
+	if (LoadMeter != LOADMETER_OFF) {
+		drawloadmeter();
+	}
+
+	while (!SwapRelease) {		// spin until this flag is set
+		fillaudio();			// (do something useful while we wait)
+		IDLE();
+	}
+	NOP();
+	SwapRelease = 0;			// clear flag (for next time)
+}
+
+void initswapbuffers(void)
+{
+	SwapRelease = 0;
+	SwapInterval = 1;
+	SwapCounter = 1;
+}
+
+void swapinterval(uint8_t i)
+{
+	if (i != 0) {
+		SwapInterval = i;
+	}
+}
+
+
+//
+// percent of the last frame (see swapinterval()) that the game spent busy, rather than
+// waiting in swapbuffers().  this includes time taken by the ISR (display and audio).
+// 100 means the game missed the end of the frame, so it is running slower than it should.
+// (with AUDIO_FIFO, rendering audio while waiting counts as idle time)
+//
+byte cpuload(void)
+{
+	return CpuLoad;
+}
+
+
+//
+// show the load on the display while playtesting:
+//	LOADMETER_PIXEL		the bottom right pixel is green, yellow (over 75%), or red (missed a frame)
+//	LOADMETER_BAR		the bottom row is a bar, 0 to 7 pixels long, colored the same way
+//	LOADMETER_OFF		no meter (the default)
+//
+// the meter is drawn in swapbuffers(), over whatever the game drew there.
+//
+void loadmeter(byte mode)
+{
+	LoadMeter = mode;
+}
+
+
+void cleardisplay(void)
+{
+	uint8_t i;
+
+	// initialize display buffer
+
+	for (i = 0; i < 10; i++) {
+		Disp[i] = 0x0;
+	}
+
+	//CurRow = 0;			// XXX needed??
+
+	//Disp[0] = 0x40;		/* XXX debug: turn on just one pixel */
+}
+
+
+//
+// set the current color (RED, GREEN, ...)
+//
+void setcolor(uint8_t c)
+{
+	_CurColor = 0x3 & c;
+}
+
+
+//
+// get the current color (returns it).
+//
+uint8_t getcolor(void)
+{
+	return _CurColor;
+}
+
+//
+// draw a point (single pixel) at coordinates (x y),
+//	using the current color.
+//
+//	note: upper left is (0 0) and lower right is (6 4)
+//
+//
+void drawpoint(uint8_t x, uint8_t y)
+{
+	uint8_t bits;
+
+	if ((x < 7) && (y < 5)) {	// clipping
+		bits = 0x40 >> x;
+		if (_CurColor & 0x1) {	// red plane
+			Disp[y+5] |= bits;
+		} else {
+			Disp[y+5] &= ~bits;
+		}
+		if (_CurColor & 0x2) {	// green plane
+			Disp[y] |= bits;
+		} else {
+			Disp[y] &= ~bits;
+		}
+	}
+}
+
+
+//
+// return the pixel at coordinates (x y).
+//	the value returned is the color.
+//	note: coordinates outside of the screen range will return BLACK (0).
+//
+uint8_t readpixel(uint8_t x, uint8_t y)
+{
+	uint8_t bits;
+	uint8_t value;
+
+	if ((x < 7) && (y < 5)) {	// clipping
+		value = 0;
+		bits = 0x40 >> x;
+		if (Disp[y] & bits) {	// check green plane
+			value |= GREEN;
+		}
+		if (Disp[y+5] & bits) {	// check red plane
+			value |= RED;
+		}
+		return value;
+	} else {
+		return 0;
+	}
+}
+
+
+
+//
+//	draw a filled rectangle from (x1 y1) to (x2 y2)
+//
+//	XXX probably could be optimized more
+//
+void drawfilledrect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+	uint8_t bits;
+	uint8_t x, y, tmp;
+
+	if ((x1 < 7) && (y1 < 5) && (x2 < 7) && (y2 < 5)) {	// clipping
+		if (x1 > x2) {
+			tmp = x1;
+			x1 = x2;
+			x2 = tmp;
+		}
+		if (y1 > y2) {
+			tmp = y1;
+			y1 = y2;
+			y2 = tmp;
+		}
+		for (y = y1; y <= y2; y++) {
+			for (x = x1; x <= x2; x++) {
+				bits = 0x40 >> x;
+				if (_CurColor & 0x1) {	// red plane
+					Disp[y+5] |= bits;
+				} else {
+					Disp[y+5] &= ~bits;
+				}
+				if (_CurColor & 0x2) {	// green plane
+					Disp[y] |= bits;
+				} else {
+					Disp[y] &= ~bits;
+				}
+			}
+		}
+	}
+}
+
+
+//
+//	draw a frame of a spriteset (see struct spriteset in miggl.h), with its upper left
+//	corner at (x y).  the sprite can be partly (or completely) off the screen.
+//
+//	black pixels are transparent.  the other pixels are drawn in their own colors
+//	(the current color doesn't matter).
+//
+void drawsprite(const struct spriteset *set, byte frame, int8_t x, int8_t y)
+{
+	const byte *fp;
+	const byte *rp;
+	uint8_t h, j, g, r, mask;
+
+	if (frame == NO_FRAME) {
+		return;
+	}
+	fp = set->frames + pgm_read_word(&set->offsets[frame]);
+	if ((x >= XSCREEN) || (x <= -(int8_t)pgm_read_byte(fp))) {
+		return;						// (nothing on screen)
+	}
+	h = pgm_read_byte(fp+1);
+	fp += 2;
+
+	for (j = 0; j < h; j++, y++) {
+		rp = set->rows + 2 * pgm_read_byte(fp + j);
+		if ((y < 0) || (y >= YSCREEN)) {	// clipping
+			continue;
+		}
+		g = pgm_read_byte(rp);
+		r = pgm_read_byte(rp+1);
+		if (x >= 0) {
+			g >>= x;
+			r >>= x;
+		} else {
+			g = (g << -x) & 0x7f;
+			r = (r << -x) & 0x7f;
+		}
+		mask = ~(g | r);
+		Disp[y] = (Disp[y] & mask) | g;			// green plane
+		Disp[y+5] = (Disp[y+5] & mask) | r;		// red plane
+	}
+}
+
+
+//
+//	return the frame number of item i of a font or animation list (made by tools/assetc),
+//	for drawsprite().  for a font, i is the character, e.g. getframe(MyFont, 'A').
+//	returns NO_FRAME if the list doesn't have item i.
+//
+byte getframe(const byte *list, byte i)
+{
+	i -= pgm_read_byte(list);				// first
+	if (i >= pgm_read_byte(list+1)) {		// count
+		return NO_FRAME;
+	}
+	return pgm_read_byte(list + 2 + i);
+}
+
+
+// a simple API for making sounds.
+
+//
+// convert one of the WT_* constants into a pointer to its table (NULL if invalid, or a
+// custom table that hasn't been set).
+//
+// note: noise voices use the square wave table for their level.  (see noise_render())
+//
+static const uint8_t *getwavetable(byte wtable)
+{
+	if (wtable == WT_SINE) {
+		return SineWtable[0];
+	} else if (wtable == WT_SAWTOOTH) {
+		return SawWtable[0];
+	} else if ((wtable == WT_SQUARE) || (wtable == WT_NOISE)) {
+		return SquareWtable[0];
+	} else if ((wtable >= WT_CUSTOM) && (wtable < WT_CUSTOM + NUM_CUSTOM_WT)) {
+		return CustomWtable[wtable - WT_CUSTOM];
+	}
+	return NULL;
+}
+
+
+//
+// note: this can be called while audio is playing (the timer ISR may be running), so the
+// reset is done with interrupts off.  it's short - the envelope has no divides to do here.
+//
+void initaudio(void)
+{
+	uint8_t i, mixvol;
+	uint16_t period;
+
+	// work these out before turning interrupts off (the tempo is a 32 bit divide)
+	period = TEMPOPERIOD(DEFAULTTEMPO);
+	mixvol = pgm_read_byte(&LevelTab[MAX_VOLUME][MAX_VOLUME]);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		VoiceMask = 0;
+		PWMval = 0;
+		AudioCmd = AudioCmdSeen = 0;
+
+		// silent voices, with the default wavetable (WT_SAWTOOTH), default envelope, full volume,
+		// and empty command queues
+		MasterVolume = MAX_VOLUME;
+		SfxMode = SFX_DUCK;
+		for (i = 0; i < NUM_VOICES; i++) {
+			Voice[i].phase = 0;
+			Voice[i].dur = 0;
+			Voice[i].envstate = ENV_OFF;
+			Voice[i].level = 0;
+			Voice[i].wavPtr = Voice[i].wavRow = SawWtable[0];
+			Voice[i].lvl = 0;
+			Voice[i].noise = 0;
+			Voice[i].msleft = 0;
+			Voice[i].morphcount = Voice[i].morphrate = 0;
+			Voice[i].lfsr = LFSR_SEED;
+			Voice[i].smpPtr = NULL;
+			Voice[i].attack = Voice[i].decay = Voice[i].release = 0xffff;	// (as setenvelope(i, 0, 0, 255, 0))
+			Voice[i].sustain = 255;
+			Voice[i].vol = MAX_VOLUME;
+			Voice[i].mixvol = mixvol;
+			Voice[i].songreq = 0;
+			Voice[i].cmdhead = Voice[i].cmdtail = 0;
+		}
+
+		// default tempo
+		TempoPeriod = TempoCount = period;
+		EnvCount = TICKS_PER_MS;
+	}
+}
+
+
+//
+// sets tempo (in beats, i.e. quarter notes, per minute) for all voices.
+// the default tempo is 120 beats per minute.
+//
+// this can be changed while a song is playing, and takes effect at the next unit
+// (1/48 of a whole note).  the slowest tempo is MINTEMPO (2 bpm, at a 20khz AUDIO_RATE).
+//
+void settempo(byte bpm)
+{
+	uint16_t period;
+
+	if (bpm < MINTEMPO) {
+		bpm = MINTEMPO;
+	}
+	period = TEMPOPERIOD(bpm);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (the ISR reloads TempoCount from this)
+		TempoPeriod = period;
+	}
+}
+
+
+//
+// set the volume envelope (ADSR) for one voice (0 to NUM_VOICES-1):
+//	attack is the time (in ms) to rise from silence to full level when a note starts,
+//	decay is the time (in ms) to then fall from full level to the sustain level (0 to 255),
+//	release is the time (in ms) to fall from full level to silence when the note ends.
+//
+// times of 0 are instant.  the default, setenvelope(voice, 0, 0, 255, 0), gives plain
+// "rectangular" notes.
+//
+// note: each note ends with a short pause (see NOTE_SEP), so a long release is cut short
+//	by the next note, which starts its attack from wherever the release got to.
+//
+void setenvelope(byte voice, uint16_t attack, uint16_t decay, byte sustain, uint16_t release)
+{
+	struct voice *v;
+
+	if (voice >= NUM_VOICES) {
+		return;
+	}
+	v = &Voice[voice];
+
+	// convert times into steps per 1ms (before turning interrupts off - the divides are slow)
+	attack = (attack != 0) ? (0xffff / attack) : 0xffff;
+	decay = (decay != 0) ? (0xffff / decay) : 0xffff;
+	release = (release != 0) ? (0xffff / release) : 0xffff;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (envelope_tick() reads these)
+		v->attack = attack;
+		v->decay = decay;
+		v->sustain = sustain;
+		v->release = release;
+	}
+}
+
+
+//
+// set the master volume (0 to MAX_VOLUME), which scales all voices.  MAX_VOLUME is the default.
+//
+// like the envelopes, volume just selects which copy of the wavetable is played,
+// so it takes effect within 1ms and costs nothing per sample.
+//
+void setvolume(byte vol)
+{
+	uint8_t i;
+
+	if (vol > MAX_VOLUME) {
+		vol = MAX_VOLUME;
+	}
+	MasterVolume = vol;
+	for (i = 0; i < NUM_VOICES; i++) {
+		Voice[i].mixvol = pgm_read_byte(&LevelTab[Voice[i].vol][vol]);
+	}
+}
+
+
+//
+// set the volume of just one voice (0 to NUM_VOICES-1).  this is scaled by the master volume.
+//
+void setvoicevolume(byte voice, byte vol)
+{
+	if (voice >= NUM_VOICES) {
+		return;
+	}
+	if (vol > MAX_VOLUME) {
+		vol = MAX_VOLUME;
+	}
+	Voice[voice].vol = vol;
+	Voice[voice].mixvol = pgm_read_byte(&LevelTab[vol][MasterVolume]);
+}
+
+
+//
+// wavetables are just arrays of samples that produce waveforms.
+// from the API all tables are just referenced by named constants.
+// WT_SAWTOOTH is the default.
+//
+// WT_NOISE isn't really a table - it makes the voice play noise.  the note still matters:
+// higher notes give higher pitched noise.  a short envelope (see setenvelope()) makes
+// good drums, e.g. setenvelope(voice, 0, 60, 0, 0).
+//
+// note: this sets the wavetable for all voices.  (see setvoicewavetable())
+//
+void setwavetable(byte wtable)
+{
+	uint8_t i;
+
+	for (i = 0; i < NUM_VOICES; i++) {
+		setvoicewavetable(i, wtable);
+	}
+}
+
+
+//
+// set the wavetable for just one voice (0 to NUM_VOICES-1).
+//
+void setvoicewavetable(byte voice, byte wtable)
+{
+	const uint8_t *wp;
+
+	wp = getwavetable(wtable);
+	if ((wp != NULL) && (voice < NUM_VOICES)) {
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (envelope_tick() reads wavPtr)
+			Voice[voice].morphcount = Voice[voice].morphrate = 0;
+			Voice[voice].wavPtr = wp;
+			Voice[voice].noise = (wtable == WT_NOISE);
+		}
+	}
+}
+
+
+//
+// make a wavetable of your own available as wtable (WT_CUSTOM to WT_CUSTOM+NUM_CUSTOM_WT-1),
+// for setvoicewavetable(), setwavetable() and S_WAVE.  the table is built in flash with
+// WT_SCALED() from miggl-private.h, and passed as its first row, e.g.
+//	static const uint8_t BuzzWtable[WT_LEVELS-1][WTABSIZE] PROGMEM = WT_SCALED(BUZZ_VALUES);
+//	setcustomwavetable(WT_CUSTOM, BuzzWtable[0]);
+//
+// voices already playing wtable carry on with the table they had.
+//
+void setcustomwavetable(byte wtable, const uint8_t *table)
+{
+	if ((wtable >= WT_CUSTOM) && (wtable < WT_CUSTOM + NUM_CUSTOM_WT)) {
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (S_WAVE reads it in the ISR)
+			CustomWtable[wtable - WT_CUSTOM] = table;
+		}
+	}
+}
+
+
+//
+// morph one voice through count tables made by WT_MORPH() (see miggl-private.h), passed as
+// the first row of the first table, e.g. setvoicemorph(0, MyMorph[0][0], 5, 20).
+//
+// with a rate (in ms), every note starts from the first table and moves on a table every
+// rate ms, stopping at the last one - a timbre sweep, like a filter envelope.  with a rate
+// of 0, each note plays the next table, so the sound changes over a run of notes.
+//
+// the tables are worked out ahead of time, so the ISR only moves wavPtr (and the envelope
+// picks the level row from it, as usual).  a morph ends when the voice's wavetable is set.
+//
+void setvoicemorph(byte voice, const uint8_t *tables, byte count, byte rate)
+{
+	struct voice *v;
+
+	if ((voice >= NUM_VOICES) || (tables == NULL) || (count == 0)) {
+		return;
+	}
+	v = &Voice[voice];
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (the ISR reads all of these)
+		v->wavPtr = v->morphPtr = tables;
+		v->noise = 0;
+		v->morphstep = rate ? 0 : 255;
+		v->morphtimer = v->morphrate = rate;
+		v->morphcount = count;
+	}
+}
+
+
+//
+// queue a note for a voice: delta is the wavetable step (0 for a rest), dur is in units,
+// or in ms with CMD_MS.  returns 0 if the voice's queue is full.
+//
+// note: this runs in main code, and only moves cmdhead once the entry is complete.
+//
+static uint8_t audio_post(uint8_t voice, uint16_t delta, uint16_t dur)
+{
+	struct voice *v;
+	struct audiocmd *cmd;
+	uint8_t head;
+
+	v = &Voice[voice];
+	head = v->cmdhead;
+	if ((uint8_t)(head - v->cmdtail) >= CMDQSIZE) {
+		return 0;
+	}
+
+	cmd = &v->cmdq[head & (CMDQSIZE-1)];
+	cmd->delta = delta;
+	cmd->dur = ((dur & ~CMD_MS) != 0) ? dur : (dur | 1);
+
+	__asm__ volatile("" ::: "memory");		// entry must be stored before the ISR can see it
+	v->cmdhead = head + 1;
+	AudioCmd++;
+
+	return 1;
+}
+
+
+//
+// play a tone with pitch in Hz, and dur in ms, on voice 0.
+// the current wavetable is used.
+//
+// the tone is queued, so it plays after the current note (or song) and any other queued notes.
+// the duration is counted in ms (on the envelope tick), whatever the tempo, and the tone
+// sounds for all but its last ms.  returns 1 if the tone was queued, 0 if the queue was full.
+//
+byte playsound(int pitch, int dur)
+{
+	uint16_t delta;
+
+	if ((pitch <= 0) || (dur <= 0)) {		// error check
+		return 0;
+	}
+
+	// wavetable step for this pitch is 256 * WTABSIZE * pitch / AUDIO_RATE
+	delta = ((uint32_t)pitch * (256 * WTABSIZE) + AUDIO_RATE/2) / AUDIO_RATE;
+
+	if ((uint16_t)dur > 0x7fff) {			// (only possible where an int is more than 16 bits)
+		dur = 0x7fff;
+	}
+	return audio_post(0, delta, (uint16_t)dur | CMD_MS);
+}
+
+
+//
+// play a tone with pitch "note" (uses predefined constants like C4 for middle C) and
+// duration dur (predefined constants like N_QUARTER, etc.) on voice 0.
+// the current wavetable is used.
+//
+// the note is queued, so several notes can be queued without waiting.  they play after
+// the current note (or song) finishes.  returns 1 if the note was queued, 0 if the queue was full.
+//
+byte playnote(byte note, byte dur)
+{
+	if ((note == N_REST) || (note < MIN_NOTE) || (note > N_C6)) {
+		return audio_post(0, 0, dur);
+	}
+	return audio_post(0, GETNOTEDELTA(note), dur);
+}
+
+
+//
+// R2Nx - this converts a ratio (e.g. 1.000) into a standard note (e.g. a frequency),
+// where "x" is the octave number (e.g. for middle C, x = 4).
+//
+// this is used to build the "note table" needed by the audio code.
+//
+// the table was made for a 20khz tick, so it is scaled for other AUDIO_RATEs.
+//
+#define R2N3(ratio)		(uint16_t)(ratio*64.0*20000.0/AUDIO_RATE+0.5)	
+
+//
+// convert ratio into "frequency" for audio code in ISR
+//
+#define R2N4(ratio)		(uint16_t)(ratio*128.0*20000.0/AUDIO_RATE+0.5)	
+
+//
+// octave higher than above (saves typing below)
+//
+#define R2N5(ratio)		(uint16_t)(ratio*256.0*20000.0/AUDIO_RATE+0.5)	
+
+//
+// table of "frequencies" for standard piano notes
+//
+// this table converts standard piano notes (e.g. N_C4) into 8.8 fixed point deltas
+//	used in the wavetable synthesis code.
+//
+// note: currently, to make the math simpler, notes are transposed a bit.
+//		for example, C5 is about 625 Hz when it really should be 523.251 Hz.  (off by about 3 half steps)
+//		but, the final pitches should be relatively accurate because they are based on ratios
+//
+// also see GETNOTEDELTA() macro which references NoteTab.
+//
+uint16_t NoteTab[] = {
+R2N3(1.000),	// N_C3 - C3 (1 octave below middle C)
+R2N3(1.059),	// N_CS3
+R2N3(1.122),	// N_D3
+R2N3(1.189),	// N_DS3
+R2N3(1.260),	// N_E3
+R2N3(1.335),	// N_F3  
+R2N3(1.414),	// N_FS3
+R2N3(1.498),	// N_G3
+R2N3(1.587),	// N_GS3
+R2N3(1.682),	// N_A3	- A3 (220 Hz)
+R2N3(1.782),	// N_AS3
+R2N3(1.888),	// N_B3
+
+R2N4(1.000),	// N_C4 - C4 (middle C)
+R2N4(1.059),	// N_CS4
+R2N4(1.122),	// N_D4
+R2N4(1.189),	// N_DS4
+R2N4(1.260),	// N_E4
+R2N4(1.335),	// N_F4  
+R2N4(1.414),	// N_FS4
+R2N4(1.498),	// N_G4
+R2N4(1.587),	// N_GS4
+R2N4(1.682),	// N_A4	- A4 (440 Hz)
+R2N4(1.782),	// N_AS4
+R2N4(1.888),	// N_B4
+
+R2N5(1.000),	// N_C5	- C5 (1 octave above middle C)
+R2N5(1.059),	// N_CS5
+R2N5(1.122),	// N_D5
+R2N5(1.189),	// N_DS5
+R2N5(1.260),	// N_E5
+R2N5(1.335),	// N_F5 
+R2N5(1.414),	// N_FS5
+R2N5(1.498),	// N_G5
+R2N5(1.587),	// N_GS5
+R2N5(1.682),	// N_A5	- A5 (880 Hz)
+R2N5(1.782),	// N_AS5
+R2N5(1.888),	// N_B5
+R2N5(2.000),	// N_C6	- C6 (2 octaves above middle C)
+};
+
+
+//
+// play a song, that is, a sequence of notes and durations.
+// this is passed an array of bytes, which is filled with note/duration pairs,
+// and must end with the byte N_END.
+//
+// a song can also contain song commands (S_REPEAT, S_CALL, etc - see miggl.h) in place
+// of notes, so repeated parts don't need to be written out.  for example:
+//	S_REPEAT, 4,  N_C4, N_8TH,  N_G4, N_8TH,  S_ENDREPEAT, 0,  N_END
+//
+// the song is played on voice 0.  (see playsongvoice())
+//
+void playsong(byte *songtable)
+{
+	playsongvoice(0, songtable);
+}
+
+
+//
+// post a song request for a voice.  kind says what song is (SONG_TABLE, etc), and track is
+// the tracker music for SONG_TRACKER.  (see audio_docmds())
+// the caller then bumps AudioCmd.
+//
+static void voice_request(struct voice *v, uint8_t kind, const uint8_t *song,
+	const struct tracksong *track)
+{
+	v->songreq = 0;					// (so the ISR can't pick up a half-written request)
+	v->newsong = song;
+	v->newkind = kind;
+	v->newtrack = track;
+	v->songflush = v->cmdhead;
+
+	__asm__ volatile("" ::: "memory");
+	v->songreq = 1;
+}
+
+
+//
+// play a song on one voice (0 to NUM_VOICES-1).
+// songs on different voices play at the same time, and are mixed together.
+// if a song is already playing on this voice, it is replaced (along with any queued notes).
+//
+// note: the ISR starts the song on its next pass.  (see audio_docmds())
+//
+void playsongvoice(byte voice, byte *songtable)
+{
+	if ((songtable == NULL) || (voice >= NUM_VOICES)) {		// error check
+		return;
+	}
+
+	voice_request(&Voice[voice], SONG_TABLE, songtable, NULL);
+	AudioCmd++;
+}
+
+
+//
+// play a packed song on one voice (0 to NUM_VOICES-1), like playsongvoice().
+//
+// packed songs are made from MML or RTTTL text by tools/songc (see the Makefile), which
+// writes them out as PROGMEM arrays.  most notes take one byte.
+//
+void playpackedsong(byte voice, const byte *songdata)
+{
+	if ((songdata == NULL) || (voice >= NUM_VOICES)) {		// error check
+		return;
+	}
+
+	voice_request(&Voice[voice], SONG_PACKED, songdata, NULL);
+	AudioCmd++;
+}
+
+
+//
+// play tracker music (see struct tracksong in miggl.h) on voices 0 to NUM_TRACKS-1,
+// replacing whatever they were playing.  for example:
+//
+//	const byte Patterns[] PROGMEM = {
+//		N_C4, T_HOLD, N_E4, N_G4,		// pattern 0
+//		N_C3, T_HOLD, T_HOLD, N_REST,	// pattern 1
+//	};
+//	const byte Melody[] PROGMEM = { 0, 0, TRK_LOOP };
+//	const byte Bass[] PROGMEM = { 1, 1, TRK_LOOP };
+//	struct tracksong Tune = { Patterns, 4, N_8TH, { Melody, Bass } };
+//
+//	playtracker(&Tune);
+//
+// note: the tracksong itself must stay around while it plays (it is read at row changes).
+//
+void playtracker(const struct tracksong *song)
+{
+	uint8_t i;
+
+	if (song == NULL) {
+		return;
+	}
+
+	for (i = 0; i < NUM_TRACKS; i++) {
+		voice_request(&Voice[i], SONG_TRACKER, song->order[i], song);
+	}
+	AudioCmd++;				// (all the tracks start on the same pass of the ISR)
+}
+
+
+//
+// set the table of phrases that songs can play with S_CALL.  phrases is an array of
+// pointers to song tables (each ending with N_END), and S_CALL, n plays phrases[n].
+// the same phrases are used by all voices.
+//
+// note: S_CALL does no range checking on n!
+//
+void setsongphrases(byte **phrases)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// (S_CALL reads it in the ISR)
+		SongPhrases = phrases;
+	}
+}
+
+
+//
+// play a sound effect (a song table, like playsong()) on SFX_VOICE.
+//
+// the effect only starts if nothing is playing there, or if its priority (SFX_LOW, SFX_MEDIUM
+// or SFX_HIGH) is at least that of the effect currently playing.  returns 1 if it started.
+//
+// music keeps playing underneath (see setsfxmode()), so when the effect ends the music
+// simply carries on from wherever it has got to.
+//
+byte playsfx(byte *songtable, byte priority)
+{
+	if (isvoiceplaying(SFX_VOICE) && (priority < SfxPriority)) {
+		return 0;
+	}
+
+	SfxPriority = priority;
+	playsongvoice(SFX_VOICE, songtable);
+
+	return 1;
+}
+
+
+//
+// play a sample (see struct sample in miggl.h) on one voice (0 to NUM_VOICES-1), replacing
+// whatever it was playing, like playsongvoice().  the voice's volume applies, but not its
+// envelope or wavetable.
+//
+// samples are made from WAV files by tools/samplec (see the Makefile).
+//
+// note: the struct sample itself must stay around until the ISR starts it.
+//
+void playsample(byte voice, const struct sample *s)
+{
+	struct voice *v;
+
+	if ((s == NULL) || (s->length == 0) || (voice >= NUM_VOICES)) {		// error check
+		return;
+	}
+
+	v = &Voice[voice];
+	v->songreq = 0;					// (the step goes with the request)
+	v->newdelta = ((uint32_t)s->rate * 256 + AUDIO_RATE/2) / AUDIO_RATE;
+	voice_request(v, SONG_SAMPLE, (const uint8_t *)s, NULL);
+	AudioCmd++;
+}
+
+
+//
+// play a sample as a sound effect, on SFX_VOICE.  (see playsfx() for priority)
+// returns 1 if it started.
+//
+byte playsfxsample(const struct sample *s, byte priority)
+{
+	if (isvoiceplaying(SFX_VOICE) && (priority < SfxPriority)) {
+		return 0;
+	}
+
+	SfxPriority = priority;
+	playsample(SFX_VOICE, s);
+
+	return 1;
+}
+
+
+//
+// choose how music is mixed while a sound effect plays:
+//	SFX_DUCK (default) plays the music at half volume, SFX_OVERRIDE silences it.
+//
+void setsfxmode(byte mode)
+{
+	SfxMode = mode;
+}
+
+
+//
+// this returns 1 if audio is playing (on any voice), 0 otherwise.
+//
+// note: with AUDIO_FIFO, audio is still playing until the FIFO has drained.
+//
+byte isaudioplaying(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < NUM_VOICES; i++) {
+		if (isvoiceplaying(i)) {
+			return 1;
+		}
+	}
+#ifdef AUDIO_FIFO
+	return (AudioFifoHead != AudioFifoTail);
+#else
+	return 0;
+#endif
+}
+
+
+//
+// this returns 1 if a song (or queued note) is playing on the given voice, 0 otherwise.
+//
+byte isvoiceplaying(byte voice)
+{
+	struct voice *v;
+
+	if (voice >= NUM_VOICES) {		// error check
+		return 0;
+	}
+	v = &Voice[voice];
+	return (((VoiceMask >> voice) & 0x1) || v->songreq || (v->cmdhead != v->cmdtail));
+}
+
+
+//
+// this waits until audio (e.g. note or song) is finished on all voices, then returns.
+//
+void waitaudio(void)
+{
+	while (isaudioplaying()) {
+		fillaudio();
+		IDLE();
+	}
+	
+	return;
+}
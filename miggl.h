@@ -1,168 +1,345 @@
-/*
- *	miggl.h - Mignonette Game Library, v0.93 - definitions
- *
- *	author(s): rolf van widenfelt (rolfvw at pizzicato dot com) (c) 2008 - Some Rights Reserved
- *
- *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
- *		(attribution, non-commercial, share-alike)
- *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
- *
- *	revision history:
- *
- *	- apr 12, 2009 - rolf
- *		add readpixel() function.
- *
- *	- may 24, 2008 - rolf
- *		move MIN_NOTE constant to here.
- *
- *	- may 22, 2008 - rolf
- *		add another octave of notes, C3 to B3.
- *			(note: need to adjust MIN_NOTE constant in miggl-private.h)
- *
- *	- may 18, 2008 - rolf
- *		minor cleanup & comments.
- *
- *	- may 17, 2008 - rolf
- *		add wavetable constants (WT_SINE, etc)
- *
- *	- may 13, 2008 - rolf
- *		add piano notes N_C4, etc.  add durations N_QUARTER, etc.
- *
- *	- apr 27, 2008 - rolf
- *		release under Creative Commons CC-by-nc-sa license.
- *
- *	- apr 19, 2008 - rolf
- *		track changes to miggl.c.
- *
- *	- apr 17, 2008 - rolf
- *		created.
- *
- *
- */
-
-
-/* colors */
-#define BLACK	0
-#define RED		1
-#define GREEN	2
-#define YELLOW	3
-
-/* display size (in pixels) */
-#define XSCREEN 7
-#define YSCREEN 5
-
-/* notes (incomplete!) */
-#define N_END	0
-#define N_REST	255
-
-#define N_C3	28		// C3 (1 octave below middle C)
-#define N_CS3	29
-#define N_D3	30
-#define N_DS3	31
-#define N_E3	32
-#define N_F3	33  
-#define N_FS3	34
-#define N_G3	35
-#define N_GS3	36
-#define N_A3	37		// A3 (220 Hz)
-#define N_AS3	38
-#define N_B3	39
-
-#define N_C4	40		// C4 (middle C)
-#define N_CS4	41
-#define N_D4	42
-#define N_DS4	43
-#define N_E4	44
-#define N_F4	45  
-#define N_FS4	46
-#define N_G4	47
-#define N_GS4	48
-#define N_A4	49		// A4 (440 Hz)
-#define N_AS4	50
-#define N_B4	51
-
-#define N_C5	52		// C5 (1 octave above middle C - 523.251 Hz)
-#define N_CS5	53
-#define N_D5	54
-#define N_DS5	55
-#define N_E5	56
-#define N_F5	57
-#define N_FS5	58
-#define N_G5	59
-#define N_GS5	60
-#define N_A5	61
-#define N_AS5	62
-#define N_B5	63
-#define N_C6	64
-
-// always set to the lowest note!
-#define MIN_NOTE	N_C3
-
-#define N_16TH 		3
-#define N_8TH 		6
-#define N_QUARTER	12
-#define N_HALF		24
-#define N_WHOLE		48
-
-// XXX need more...
-#define N_HALF_DOT	36
-#define N_8TH_TRIP 	4
-
-
-/* wavetable choices - used with setwavetable() */
-#define WT_SAWTOOTH		1
-#define WT_SINE			2
-#define WT_SQUARE		3
-
-
-/* globals for buttons */
-extern byte ButtonA;
-extern byte ButtonB;
-extern byte ButtonC;
-extern byte ButtonD;
-extern byte ButtonAEvent;
-extern byte ButtonBEvent;
-extern byte ButtonCEvent;
-extern byte ButtonDEvent;
-
-
-extern volatile uint8_t Disp[];		// XXX probably shouldn't access this!
-
-
-/* graphics functions */
-
-void swapbuffers(void);
-void initswapbuffers(void);
-void swapinterval(uint8_t i);
-void cleardisplay(void);
-void setcolor(uint8_t c);
-void drawpoint(uint8_t x, uint8_t y);
-uint8_t readpixel(uint8_t x, uint8_t y);
-void drawfilledrect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
-
-
-/* button functions */
-
-void button_init(void);
-void poll_buttons(void);
-void handlebuttons(void);
-
-
-/* audio functions */
-
-void initaudio(void);
-
-//void playsound(int pitch, int dur);
-
-void settempo(byte bpm);
-void setwavetable(byte wtable);
-void playnote(byte note, byte dur);
-void playsong(byte *songtable);
-
-byte isaudioplaying(void);		// returns 1 if audio is playing, 0 otherwise
-void waitaudio(void);			// waits until audio (e.g. note or song) is finished
-
-
-/* XXX stuff that probably shouldn't be here... */
-void avrinit(void);
-void start_timer1(void);
+/*
+ *	miggl.h - Mignonette Game Library, v0.93 - definitions
+ *
+ *	author(s): rolf van widenfelt (rolfvw at pizzicato dot com) (c) 2008 - Some Rights Reserved
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		add NUM_VOICES, playsongvoice(), setvoicewavetable() and isvoiceplaying().
+ *		add playsfx(), setsfxmode() and SFX_* constants.
+ *		add fillaudio().
+ *		all duration values now work (add dotted and triplet constants).
+ *		playnote() and playsound() are implemented, and return 0 if the note queue is full.
+ *		add setenvelope().
+ *		add setvolume(), setvoicevolume() and MAX_VOLUME.
+ *		add WT_NOISE.
+ *		add song commands (S_REPEAT, S_CALL, etc), setsongphrases() and MAX_NOTE.
+ *		add struct tracksong and playtracker().
+ *		add playpackedsong().
+ *		add struct spriteset, drawsprite() and getframe().
+ *		add getbuttonmask(), setreplay(), isreplaying() and framehash().
+ *		add cpuload(), loadmeter() and LOADMETER_* constants.
+ *		add stack_headroom().
+ *		add struct sample, playsample() and playsfxsample().
+ *		add WT_CUSTOM, setcustomwavetable() and setvoicemorph().
+ *
+ *	- apr 12, 2009 - rolf
+ *		add readpixel() function.
+ *
+ *	- may 24, 2008 - rolf
+ *		move MIN_NOTE constant to here.
+ *
+ *	- may 22, 2008 - rolf
+ *		add another octave of notes, C3 to B3.
+ *			(note: need to adjust MIN_NOTE constant in miggl-private.h)
+ *
+ *	- may 18, 2008 - rolf
+ *		minor cleanup & comments.
+ *
+ *	- may 17, 2008 - rolf
+ *		add wavetable constants (WT_SINE, etc)
+ *
+ *	- may 13, 2008 - rolf
+ *		add piano notes N_C4, etc.  add durations N_QUARTER, etc.
+ *
+ *	- apr 27, 2008 - rolf
+ *		release under Creative Commons CC-by-nc-sa license.
+ *
+ *	- apr 19, 2008 - rolf
+ *		track changes to miggl.c.
+ *
+ *	- apr 17, 2008 - rolf
+ *		created.
+ *
+ *
+ */
+
+
+/* colors */
+#define BLACK	0
+#define RED		1
+#define GREEN	2
+#define YELLOW	3
+
+/* display size (in pixels) */
+#define XSCREEN 7
+#define YSCREEN 5
+
+/* notes (incomplete!) */
+#define N_END	0
+#define N_REST	255
+
+#define N_C3	28		// C3 (1 octave below middle C)
+#define N_CS3	29
+#define N_D3	30
+#define N_DS3	31
+#define N_E3	32
+#define N_F3	33  
+#define N_FS3	34
+#define N_G3	35
+#define N_GS3	36
+#define N_A3	37		// A3 (220 Hz)
+#define N_AS3	38
+#define N_B3	39
+
+#define N_C4	40		// C4 (middle C)
+#define N_CS4	41
+#define N_D4	42
+#define N_DS4	43
+#define N_E4	44
+#define N_F4	45  
+#define N_FS4	46
+#define N_G4	47
+#define N_GS4	48
+#define N_A4	49		// A4 (440 Hz)
+#define N_AS4	50
+#define N_B4	51
+
+#define N_C5	52		// C5 (1 octave above middle C - 523.251 Hz)
+#define N_CS5	53
+#define N_D5	54
+#define N_DS5	55
+#define N_E5	56
+#define N_F5	57
+#define N_FS5	58
+#define N_G5	59
+#define N_GS5	60
+#define N_A5	61
+#define N_AS5	62
+#define N_B5	63
+#define N_C6	64
+
+// always set to the lowest note!
+#define MIN_NOTE	N_C3
+
+// always set to the highest note!
+#define MAX_NOTE	N_C6
+
+//
+// song commands - these can go in a song table in place of a note, and are followed by
+// an argument (in place of the duration).  they take no time to play.
+//
+//	S_REPEAT, n			play from here to the matching S_ENDREPEAT n times (0 means forever)
+//	S_ENDREPEAT, 0
+//	S_CALL, n			play phrase n (see setsongphrases()), then carry on from here.
+//						a phrase is a song table, and returns at its N_END.
+//	S_TRANSPOSE, n		add n half steps (-128 to 127, as a byte) to the notes that follow
+//						(notes that land out of range are moved by octaves to fit)
+//	S_TEMPO, bpm		change the tempo (like settempo(), this is for all voices)
+//	S_WAVE, wtable		change this voice's wavetable (WT_SINE, etc)
+//
+// repeats and calls can be nested up to 4 deep (in total).
+//
+#define S_REPEAT		240
+#define S_ENDREPEAT		241
+#define S_CALL			242
+#define S_TRANSPOSE		243
+#define S_TEMPO			244
+#define S_WAVE			245
+
+//
+// durations are in units of 1/48 of a whole note, so any value from 1 to 255 works.
+// (see settempo())
+//
+#define N_16TH 		3
+#define N_8TH 		6
+#define N_QUARTER	12
+#define N_HALF		24
+#define N_WHOLE		48
+
+#define N_8TH_DOT		9
+#define N_QUARTER_DOT	18
+#define N_HALF_DOT		36
+#define N_16TH_TRIP		2
+#define N_8TH_TRIP 		4
+#define N_QUARTER_TRIP	8
+
+
+/* wavetable choices - used with setwavetable() */
+#define WT_SAWTOOTH		1
+#define WT_SINE			2
+#define WT_SQUARE		3
+#define WT_NOISE		4		// noise, for drums and explosions (note pitch sets how "bright" it is)
+#define WT_CUSTOM		8		// WT_CUSTOM to WT_CUSTOM+NUM_CUSTOM_WT-1 are set with setcustomwavetable()
+#define NUM_CUSTOM_WT	4
+
+/* loudest volume - used with setvolume() and setvoicevolume() */
+#define MAX_VOLUME		15
+
+
+/* number of audio voices (songs on different voices are mixed together) */
+#define NUM_VOICES		3
+
+/* the last voice is used for sound effects - see playsfx() */
+#define SFX_VOICE		(NUM_VOICES-1)
+
+/* sound effect priorities - used with playsfx() */
+#define SFX_LOW			1
+#define SFX_MEDIUM		2
+#define SFX_HIGH		3
+
+/* how music is mixed while a sound effect plays - used with setsfxmode() */
+#define SFX_OVERRIDE	0		// music is silent
+#define SFX_DUCK		1		// music is at half volume (default)
+
+
+//
+// tracker music - used with playtracker()
+//
+// a pattern is a list of rows, one byte each: a note (N_C4, etc), N_REST, or T_HOLD
+// (nothing new, the note or rest carries on).  all the patterns of a tracksong are stored
+// one after another, and each track has an order list of the pattern numbers to play.
+// patterns and order lists must be in flash (PROGMEM).
+//
+// track n plays on voice n, so there are NUM_TRACKS tracks (the sound effect voice is left alone).
+// all order lists should add up to the same number of rows.
+//
+#define NUM_TRACKS		SFX_VOICE
+
+#define T_HOLD			0		// in a pattern: nothing new on this row
+#define TRK_LOOP		254		// in an order list: go back to the start of the list
+#define TRK_END			255		// in an order list: end of the track
+
+struct tracksong {
+	const byte *patterns;			// all patterns, rows bytes each
+	byte rows;						// rows in each pattern
+	byte rowdur;					// duration of each row in units (e.g. N_16TH)
+	const byte *order[NUM_TRACKS];	// pattern numbers for each track, ending with TRK_LOOP or TRK_END
+};
+
+
+//
+// sprites - made from ASCII art by tools/assetc (see the Makefile), used with drawsprite()
+//
+// a spriteset holds frames (sprites, font characters and animation frames) from one file.
+// each frame is width, height, then a row number for each row, and each row is two bytes,
+// green and red (left justified like Disp, so 0x40 is the leftmost pixel).
+// identical rows and frames are only stored once.
+//
+// fonts and animations are lists of frame numbers:  first, count, then count frame numbers.
+// (first is the character code of the first frame of a font, 0 for an animation)
+//
+struct spriteset {
+	const byte *rows;			// two bytes (green, red) per row (in flash)
+	const byte *frames;			// frames (in flash)
+	const uint16_t *offsets;	// where each frame starts in frames (in flash)
+};
+
+#define NO_FRAME		255		// returned by getframe()
+
+
+//
+// samples - made from WAV files by tools/samplec (see the Makefile), used with playsample()
+//
+// a sample is played from flash, at its own rate, in place of a voice's wavetable.  it is
+// either 8 bit PCM (one byte per sample, 128 is the middle), or 4 bit DPCM (two samples per
+// byte, low nibble first), where each nibble picks a step (see DPCM_STEPS in miggl-private.h)
+// that is added to the last value, starting from 128.
+//
+#define SAMPLE_PCM8		0
+#define SAMPLE_DPCM4	1
+
+struct sample {
+	const byte *data;			// (in flash)
+	uint16_t length;			// in samples
+	uint16_t rate;				// samples per second (up to 255 * AUDIO_RATE, so no limit really)
+	byte format;				// SAMPLE_PCM8 or SAMPLE_DPCM4
+};
+
+/* load meter modes - used with loadmeter() (the meter is drawn over the game, in swapbuffers()) */
+#define LOADMETER_OFF	0
+#define LOADMETER_PIXEL	1		// bottom right pixel: green, yellow (over 75%), red (missed a frame)
+#define LOADMETER_BAR	2		// bottom row: a bar of 0 to 7 pixels, colored like LOADMETER_PIXEL
+
+
+//
+// replaying button presses - used with setreplay()
+//
+// a replay table is pairs of bytes:  a number of display cycles (1 to 255, each cycle is
+// 10ms), then the buttons held down for those cycles (like getbuttonmask()).  it ends with 0, 0.
+// tables are recorded by running the game on the host (host/migemu -r), and converted by
+// tools/replayc (see the Makefile).
+//
+
+
+/* globals for buttons */
+extern byte ButtonA;
+extern byte ButtonB;
+extern byte ButtonC;
+extern byte ButtonD;
+extern byte ButtonAEvent;
+extern byte ButtonBEvent;
+extern byte ButtonCEvent;
+extern byte ButtonDEvent;
+
+
+extern volatile uint8_t Disp[];		// XXX probably shouldn't access this!
+
+
+/* graphics functions */
+
+void swapbuffers(void);
+void initswapbuffers(void);
+void swapinterval(uint8_t i);
+byte cpuload(void);			// percent of the last frame the game was busy (100 if it missed the frame)
+void loadmeter(byte mode);	// show the load on the display (LOADMETER_PIXEL, etc)
+void cleardisplay(void);
+void setcolor(uint8_t c);
+void drawpoint(uint8_t x, uint8_t y);
+uint8_t readpixel(uint8_t x, uint8_t y);
+void drawfilledrect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+void drawsprite(const struct spriteset *set, byte frame, int8_t x, int8_t y);
+byte getframe(const byte *list, byte i);	// frame number i of a font or animation
+
+
+/* button functions */
+
+void button_init(void);
+void poll_buttons(void);
+void handlebuttons(void);
+byte getbuttonmask(void);				// buttons as of the last display cycle (bit 0 is A, ... bit 3 is D)
+void setreplay(const byte *table);		// replay button presses from a table (in flash), NULL to stop
+byte isreplaying(void);
+uint16_t framehash(void);				// hash of the display buffer (to compare frames)
+
+
+/* audio functions */
+
+void initaudio(void);
+
+byte playsound(int pitch, int dur);		// pitch in Hz, dur in ms (returns 0 if queue is full)
+
+void settempo(byte bpm);
+void setwavetable(byte wtable);				// sets wavetable for all voices
+void setvoicewavetable(byte voice, byte wtable);
+void setcustomwavetable(byte wtable, const uint8_t *table);	// table from WT_SCALED() (in flash)
+void setvoicemorph(byte voice, const uint8_t *tables, byte count, byte rate);	// tables from WT_MORPH()
+void setenvelope(byte voice, uint16_t attack, uint16_t decay, byte sustain, uint16_t release);	// times in ms
+void setvolume(byte vol);					// master volume (0 to MAX_VOLUME)
+void setvoicevolume(byte voice, byte vol);
+byte playnote(byte note, byte dur);			// queues a note (returns 0 if queue is full)
+void playsong(byte *songtable);					// plays on voice 0
+void playsongvoice(byte voice, byte *songtable);
+void setsongphrases(byte **phrases);		// phrases for S_CALL
+void playtracker(const struct tracksong *song);	// plays on voices 0 to NUM_TRACKS-1
+void playpackedsong(byte voice, const byte *songdata);	// songdata from tools/songc (in flash)
+byte playsfx(byte *songtable, byte priority);	// returns 1 if the effect started
+void playsample(byte voice, const struct sample *s);	// s from tools/samplec
+byte playsfxsample(const struct sample *s, byte priority);	// like playsfx()
+void setsfxmode(byte mode);
+
+byte isaudioplaying(void);		// returns 1 if audio is playing, 0 otherwise
+byte isvoiceplaying(byte voice);	// returns 1 if a song is playing on this voice, 0 otherwise
+void waitaudio(void);			// waits until audio (e.g. note or song) is finished
+void fillaudio(void);			// renders audio ahead (only needed with AUDIO_FIFO, see Makefile)
+
+
+/* XXX stuff that probably shouldn't be here... */
+void avrinit(void);
+uint16_t stack_headroom(void);	// bytes of RAM the stack has never reached (0 without -DSTACK_CHECK)
+void start_timer1(void);
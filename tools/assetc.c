@@ -0,0 +1,406 @@
+/*
+ *	assetc.c - sprite/font/animation compiler for Mignonette (runs on the host, not the AVR!)
+ *
+ *	converts ASCII art into a packed spriteset (PROGMEM arrays), for drawsprite().
+ *	see struct spriteset in miggl.h for the packed format.
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	usage:
+ *		assetc [-o out.h] art.txt
+ *
+ *	the input is a list of sprites, fonts and animations, for example:
+ *
+ *		set Art					(name of the spriteset, "Sprites" if not given)
+ *
+ *		sprite Heart
+ *		.R.R.
+ *		RRRRR
+ *		.RRR.
+ *		..R..
+ *
+ *		anim Blink				(frames are separated by lines starting with --)
+ *		G.G
+ *		--
+ *		...
+ *
+ *		font Digits 0			(the first frame is the character '0', the next '1', etc)
+ *		YYY
+ *		Y.Y
+ *		...
+ *
+ *	pixels are . (black, which is transparent), R (red), G (green) or Y (yellow).
+ *	frames can be up to 7 pixels wide and 5 high.  blank lines end a sprite, font
+ *	or animation, and lines starting with # are ignored.
+ *
+ *	the output has:
+ *		const struct spriteset Art			the spriteset
+ *		#define Heart n						frame number of each sprite
+ *		const byte Blink[] PROGMEM			font and animation lists (see getframe())
+ *		#define Blink_LEN n					number of frames in each font or animation
+ *
+ *	identical rows, and identical frames, are only stored once.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "../mydefs.h"
+#include "../miggl.h"
+
+
+#define MAXROWS		255			// (row and frame numbers are bytes)
+#define MAXFRAMES	254			// (255 is NO_FRAME)
+#define MAXITEMS	200			// sprites, fonts and animations
+#define MAXLINE		256
+#define MAXNAME		64
+
+struct frame {
+	int w, h;
+	int row[YSCREEN];			// row numbers
+};
+
+struct item {
+	char name[MAXNAME];
+	int kind;					// 's' for sprite, 'a' for animation, 'f' for font
+	int first;					// first character (fonts)
+	int nframes;
+	int *frames;				// frame numbers
+};
+
+static uint8_t Rows[MAXROWS][2];
+static int NumRows;
+static struct frame Frames[MAXFRAMES];
+static int NumFrames;
+static struct item Items[MAXITEMS];
+static int NumItems;
+
+static const char *FileName;
+static int LineNum;
+static const char *OutName;		// output file (removed if there is an error, so make tries again)
+
+
+static void error(const char *msg, const char *arg)
+{
+	fprintf(stderr, "%s:%d: %s%s\n", FileName, LineNum, msg, (arg != NULL) ? arg : "");
+	if (OutName != NULL) {
+		remove(OutName);
+	}
+	exit(1);
+}
+
+
+//
+// find (or add) a row in the row pool
+//
+static int addrow(uint8_t g, uint8_t r)
+{
+	int i;
+
+	for (i = 0; i < NumRows; i++) {
+		if ((Rows[i][0] == g) && (Rows[i][1] == r)) {
+			return i;
+		}
+	}
+	if (NumRows >= MAXROWS) {
+		error("too many different rows", NULL);
+	}
+	Rows[NumRows][0] = g;
+	Rows[NumRows][1] = r;
+	return NumRows++;
+}
+
+
+//
+// find (or add) a frame in the frame table
+//
+static int addframe(struct frame *f)
+{
+	int i;
+
+	for (i = 0; i < NumFrames; i++) {
+		if ((Frames[i].w == f->w) && (Frames[i].h == f->h)
+			&& (memcmp(Frames[i].row, f->row, f->h * sizeof(int)) == 0)) {
+			return i;
+		}
+	}
+	if (NumFrames >= MAXFRAMES) {
+		error("too many different frames", NULL);
+	}
+	Frames[NumFrames] = *f;
+	return NumFrames++;
+}
+
+
+//
+// add one line of pixels to a frame
+//
+static void addpixels(struct frame *f, const char *s)
+{
+	uint8_t g, r, bit;
+	int w;
+
+	if (f->h >= YSCREEN) {
+		error("frame is too high (5 rows at most)", NULL);
+	}
+
+	g = r = 0;
+	bit = 0x40;
+	for (w = 0; s[w] != '\0'; w++, bit >>= 1) {
+		if (w >= XSCREEN) {
+			error("frame is too wide (7 pixels at most)", NULL);
+		}
+		switch (toupper((unsigned char)s[w])) {
+			case '.':
+				break;
+			case 'R':
+				r |= bit;
+				break;
+			case 'G':
+				g |= bit;
+				break;
+			case 'Y':
+				r |= bit;
+				g |= bit;
+				break;
+			default:
+				error("bad pixel (use . R G or Y): ", s);
+		}
+	}
+
+	if ((f->h > 0) && (w != f->w)) {
+		error("rows of a frame must all be the same width", NULL);
+	}
+	f->w = w;
+	f->row[f->h++] = addrow(g, r);
+}
+
+
+static void additemframe(struct item *it, struct frame *f)
+{
+	if (f->h == 0) {
+		error("empty frame in ", it->name);
+	}
+	it->frames = realloc(it->frames, (it->nframes + 1) * sizeof(int));
+	if (it->frames == NULL) {
+		error("out of memory", NULL);
+	}
+	it->frames[it->nframes++] = addframe(f);
+	f->w = f->h = 0;
+}
+
+
+static void writeoutput(FILE *out, const char *setname)
+{
+	int i, j, n, off;
+	struct item *it;
+
+	n = NumRows*2;
+	for (i = 0; i < NumFrames; i++) {
+		n += 2 + Frames[i].h + 2;
+	}
+	fprintf(out, "\n// %s: %d frames, %d rows, %d bytes\n", setname, NumFrames, NumRows, n);
+
+	fprintf(out, "const byte %sRows[] PROGMEM = {", setname);
+	for (i = 0; i < NumRows; i++) {
+		fprintf(out, "%s0x%02x, 0x%02x,", (i % 6) ? "  " : "\n\t", Rows[i][0], Rows[i][1]);
+	}
+	fprintf(out, "\n};\n");
+
+	fprintf(out, "const byte %sFrames[] PROGMEM = {\n", setname);
+	for (i = 0; i < NumFrames; i++) {
+		fprintf(out, "\t%d, %d,", Frames[i].w, Frames[i].h);
+		for (j = 0; j < Frames[i].h; j++) {
+			fprintf(out, " %d,", Frames[i].row[j]);
+		}
+		fprintf(out, "\t\t// frame %d\n", i);
+	}
+	fprintf(out, "};\n");
+
+	fprintf(out, "const uint16_t %sOffsets[] PROGMEM = {", setname);
+	off = 0;
+	for (i = 0; i < NumFrames; i++) {
+		fprintf(out, "%s%d,", (i % 12) ? " " : "\n\t", off);
+		off += 2 + Frames[i].h;
+	}
+	fprintf(out, "\n};\n");
+
+	fprintf(out, "const struct spriteset %s = { %sRows, %sFrames, %sOffsets };\n\n",
+		setname, setname, setname, setname);
+
+	for (i = 0; i < NumItems; i++) {
+		it = &Items[i];
+		if (it->kind == 's') {
+			fprintf(out, "#define %s\t%d\n", it->name, it->frames[0]);
+		} else {
+			fprintf(out, "const byte %s[] PROGMEM = { %d, %d,", it->name,
+				(it->kind == 'f') ? it->first : 0, it->nframes);
+			for (j = 0; j < it->nframes; j++) {
+				fprintf(out, " %d,", it->frames[j]);
+			}
+			fprintf(out, " };\n#define %s_LEN\t%d\n", it->name, it->nframes);
+		}
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	char line[MAXLINE];
+	char setname[MAXNAME];
+	char word[MAXLINE], name[MAXLINE], first[MAXLINE];
+	struct item *it;
+	struct frame f;
+	FILE *in, *out;
+	char *s;
+	int i, n;
+
+	OutName = NULL;
+	FileName = NULL;
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-o") == 0) && (i+1 < argc)) {
+			OutName = argv[++i];
+		} else if (FileName == NULL) {
+			FileName = argv[i];
+		} else {
+			FileName = NULL;
+			break;
+		}
+	}
+	if (FileName == NULL) {
+		fprintf(stderr, "usage: assetc [-o out.h] art.txt\n");
+		return 1;
+	}
+
+	in = fopen(FileName, "r");
+	if (in == NULL) {
+		perror(FileName);
+		return 1;
+	}
+
+	strcpy(setname, "Sprites");
+	it = NULL;
+	f.w = f.h = 0;
+	LineNum = 0;
+	while (fgets(line, sizeof(line), in) != NULL) {
+		LineNum++;
+		line[strcspn(line, "\r\n")] = '\0';
+		for (s = line + strlen(line); (s > line) && isspace((unsigned char)s[-1]); s--) {
+			s[-1] = '\0';
+		}
+		s = line;
+		while (isspace((unsigned char)*s)) {
+			s++;
+		}
+
+		if (*s == '#') {
+			continue;
+		}
+
+		if (*s == '\0') {					// blank line ends an item
+			if ((it != NULL) && (f.h > 0)) {
+				additemframe(it, &f);
+			}
+			it = NULL;
+			continue;
+		}
+
+		if ((s[0] == '-') && (s[1] == '-')) {	// next frame
+			if (it == NULL) {
+				error("-- outside of a sprite", NULL);
+			}
+			additemframe(it, &f);
+			continue;
+		}
+
+		if (isalpha((unsigned char)*s) && (strpbrk(s, " \t") != NULL)) {	// (a header line)
+			if ((it != NULL) && (f.h > 0)) {
+				additemframe(it, &f);
+			}
+			it = NULL;
+
+			first[0] = '\0';
+			n = sscanf(s, "%s %s %s", word, name, first);
+			if ((n < 2) || (strlen(name) >= MAXNAME)
+				|| !(isalpha((unsigned char)name[0]) || (name[0] == '_'))) {
+				error("bad line: ", s);
+			}
+			if (strcmp(word, "set") == 0) {
+				strcpy(setname, name);
+				continue;
+			}
+			if (NumItems >= MAXITEMS) {
+				error("too many items", NULL);
+			}
+			it = &Items[NumItems++];
+			strcpy(it->name, name);
+			it->nframes = 0;
+			it->frames = NULL;
+			it->first = 0;
+			if (strcmp(word, "sprite") == 0) {
+				it->kind = 's';
+			} else if (strcmp(word, "anim") == 0) {
+				it->kind = 'a';
+			} else if (strcmp(word, "font") == 0) {
+				it->kind = 'f';
+				if (strlen(first) == 1) {
+					it->first = (unsigned char)first[0];
+				} else if (isdigit((unsigned char)first[0])) {
+					it->first = atoi(first);
+				} else {
+					error("font needs a first character: ", s);
+				}
+			} else {
+				error("expected sprite, anim, font or set: ", s);
+			}
+			continue;
+		}
+
+		if (it == NULL) {
+			error("pixels outside of a sprite: ", s);
+		}
+		addpixels(&f, s);
+		if ((it->kind == 's') && (it->nframes > 0)) {
+			error("a sprite has just one frame (use anim)", NULL);
+		}
+	}
+	if ((it != NULL) && (f.h > 0)) {
+		additemframe(it, &f);
+	}
+	fclose(in);
+
+	for (i = 0; i < NumItems; i++) {
+		if (Items[i].nframes == 0) {
+			LineNum = 0;
+			error("no frames in ", Items[i].name);
+		}
+	}
+
+	out = stdout;
+	if (OutName != NULL) {
+		out = fopen(OutName, "w");
+		if (out == NULL) {
+			perror(OutName);
+			return 1;
+		}
+	}
+	fprintf(out, "/*\n *\t%s - spriteset, made by tools/assetc from %s - don't edit!\n */\n",
+		(OutName != NULL) ? OutName : "(stdout)", FileName);
+	writeoutput(out, setname);
+	if (out != stdout) {
+		fclose(out);
+	}
+	return 0;
+}
@@ -0,0 +1,347 @@
+/*
+ *	ramreport.c - RAM budget report for Mignonette programs (runs on the host, not the AVR!)
+ *
+ *	reads the linker map (from -Wl,-Map) and the stack usage files (from -fstack-usage)
+ *	and prints where the RAM goes:
+ *		- .data, .bss and .noinit, for the whole program and for each object file
+ *		- what is left over for the stack
+ *		- the stack frame of every function, biggest first (ISRs are marked, since their
+ *		  frames can land on top of the deepest point of the game's own stack)
+ *
+ *	see "make ramreport".  to see how much stack is really used, call stack_headroom()
+ *	on the Mignonette after a good long play.
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	usage:
+ *		ramreport [-r ramsize] prog.map file.su ...
+ *
+ *	ramsize is 1024 (the atmega168) unless given.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+#define MAXLINE		512
+#define MAXNAME		128
+#define MAXOBJS		100
+#define MAXFUNCS	1000
+
+#define SEC_DATA	0
+#define SEC_BSS		1
+#define SEC_NOINIT	2
+#define NUM_SECS	3
+
+static const char *SecName[NUM_SECS] = { ".data", ".bss", ".noinit" };
+
+struct obj {
+	char name[MAXNAME];
+	unsigned long size[NUM_SECS];
+};
+
+struct func {
+	char name[MAXNAME];
+	char file[MAXNAME];
+	unsigned long bytes;
+	char kind[16];				// static, dynamic, bounded (see the gcc manual)
+};
+
+static struct obj Objs[MAXOBJS];
+static int NumObjs;
+static unsigned long SecTotal[NUM_SECS];
+
+static struct func Funcs[MAXFUNCS];
+static int NumFuncs;
+
+
+//
+// copy a string, cutting it off if it doesn't fit
+//
+static void copy(char *dst, const char *src, size_t size)
+{
+	size_t n;
+
+	n = strlen(src);
+	if (n >= size) {
+		n = size - 1;
+	}
+	memcpy(dst, src, n);
+	dst[n] = '\0';
+}
+
+
+static const char *basename_of(const char *path)
+{
+	const char *s;
+
+	s = strrchr(path, '/');
+	return (s != NULL) ? s+1 : path;
+}
+
+
+static struct obj *findobj(const char *name)
+{
+	int i;
+
+	for (i = 0; i < NumObjs; i++) {
+		if (strcmp(Objs[i].name, name) == 0) {
+			return &Objs[i];
+		}
+	}
+	if (NumObjs >= MAXOBJS) {
+		return NULL;
+	}
+	copy(Objs[NumObjs].name, name, MAXNAME);
+	return &Objs[NumObjs++];
+}
+
+
+//
+// which output section a section name belongs in (-1 for none we care about)
+//
+static int sectionof(const char *name)
+{
+	int i;
+	size_t n;
+
+	if (strcmp(name, "COMMON") == 0) {
+		return SEC_BSS;
+	}
+	for (i = 0; i < NUM_SECS; i++) {
+		n = strlen(SecName[i]);
+		if ((strncmp(name, SecName[i], n) == 0) && ((name[n] == '\0') || (name[n] == '.'))) {
+			return i;
+		}
+	}
+	if (strncmp(name, ".rodata", 7) == 0) {		// (on the AVR, constant data is copied to RAM)
+		return SEC_DATA;
+	}
+	return -1;
+}
+
+
+//
+// the memory map part of the map file has lines like these:
+//
+//	.data           0x00800100       0x1c load address 0x00000e2a
+//	 .data          0x00800100        0x6 miggl.o
+//	 COMMON         0x00800150        0x2 mig-sample1.o
+//
+// the first is an output section (the total), the others are input sections from each
+// object file.  a long section name puts the address and size on the next line.
+//
+static int readmap(const char *name)
+{
+	char line[MAXLINE], prev[MAXLINE], secname[MAXLINE], file[MAXLINE];
+	unsigned long addr, size;
+	struct obj *o;
+	FILE *f;
+	int insec, sec, inmap, n;
+
+	f = fopen(name, "r");
+	if (f == NULL) {
+		perror(name);
+		return 1;
+	}
+	inmap = 0;
+	insec = -1;
+	prev[0] = '\0';
+	while (fgets(line, sizeof(line), f) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (strncmp(line, "Linker script and memory map", 28) == 0) {
+			inmap = 1;
+			continue;
+		}
+		if (!inmap) {
+			continue;
+		}
+
+		// a section name alone on a line goes with the next line
+		if ((sscanf(line, " %s %lx", secname, &addr) == 1)
+			&& ((secname[0] == '.') || (strcmp(secname, "COMMON") == 0))) {
+			copy(prev, line, sizeof(prev));
+			continue;
+		}
+		if ((prev[0] != '\0') && (line[0] == ' ') && isspace((unsigned char)line[1])) {
+			copy(prev + strlen(prev), line, sizeof(prev) - strlen(prev));
+			copy(line, prev, sizeof(line));
+		}
+		prev[0] = '\0';
+
+		if (line[0] == '.') {			// output section
+			n = sscanf(line, "%s %lx %lx", secname, &addr, &size);
+			insec = sectionof(secname);
+			if ((n == 3) && (insec >= 0)) {
+				SecTotal[insec] += size;
+			} else {
+				insec = -1;
+			}
+			continue;
+		}
+		if ((line[0] == ' ') && (insec >= 0)) {		// input section
+			n = sscanf(line, " %s %lx %lx %s", secname, &addr, &size, file);
+			if ((n == 4) && (strncmp(file, "0x", 2) != 0)) {
+				sec = sectionof(secname);
+				if ((sec >= 0) && (size != 0)) {
+					o = findobj(basename_of(file));
+					if (o != NULL) {
+						o->size[insec] += size;
+					}
+				}
+			}
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+
+//
+// -fstack-usage writes a line per function:  file:line:column:function<tab>bytes<tab>kind
+//
+static int readsu(const char *name)
+{
+	char line[MAXLINE], where[MAXLINE], kind[MAXLINE];
+	unsigned long bytes;
+	struct func *fn;
+	char *s;
+	FILE *f;
+
+	f = fopen(name, "r");
+	if (f == NULL) {
+		perror(name);
+		return 1;
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (sscanf(line, "%s %lu %s", where, &bytes, kind) != 3) {
+			continue;
+		}
+		if (NumFuncs >= MAXFUNCS) {
+			break;
+		}
+		fn = &Funcs[NumFuncs++];
+		s = strrchr(where, ':');		// (the function name is after the last colon)
+		copy(fn->name, (s != NULL) ? s+1 : where, MAXNAME);
+		s = strchr(where, ':');
+		if (s != NULL) {
+			*s = '\0';
+		}
+		copy(fn->file, basename_of(where), MAXNAME);
+		copy(fn->kind, kind, sizeof(fn->kind));
+		fn->bytes = bytes;
+	}
+	fclose(f);
+	return 0;
+}
+
+
+static int bybytes(const void *a, const void *b)
+{
+	const struct func *fa = a, *fb = b;
+
+	if (fa->bytes != fb->bytes) {
+		return (fa->bytes < fb->bytes) ? 1 : -1;
+	}
+	return strcmp(fa->name, fb->name);
+}
+
+
+static int isisr(const char *name)
+{
+	return (strncmp(name, "__vector_", 9) == 0);
+}
+
+
+int main(int argc, char **argv)
+{
+	unsigned long ram, used, isrmax, fnmax, total;
+	const char *mapname;
+	int i, k, nsu;
+
+	ram = 1024;
+	mapname = NULL;
+	nsu = 0;
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-r") == 0) && (i+1 < argc)) {
+			ram = strtoul(argv[++i], NULL, 0);
+		} else if (mapname == NULL) {
+			mapname = argv[i];
+			if (readmap(mapname) != 0) {
+				return 1;
+			}
+		} else {
+			if (readsu(argv[i]) != 0) {
+				return 1;
+			}
+			nsu++;
+		}
+	}
+	if ((mapname == NULL) || (ram == 0)) {
+		fprintf(stderr, "usage: ramreport [-r ramsize] prog.map file.su ...\n");
+		return 1;
+	}
+
+	printf("RAM: %lu bytes\n\n", ram);
+	printf("%-24s %8s %8s %8s %8s\n", "object", ".data", ".bss", ".noinit", "total");
+	for (i = 0; i < NumObjs; i++) {
+		total = 0;
+		printf("%-24s", Objs[i].name);
+		for (k = 0; k < NUM_SECS; k++) {
+			printf(" %8lu", Objs[i].size[k]);
+			total += Objs[i].size[k];
+		}
+		printf(" %8lu\n", total);
+	}
+	used = 0;
+	printf("%-24s", "(all)");
+	for (k = 0; k < NUM_SECS; k++) {
+		printf(" %8lu", SecTotal[k]);
+		used += SecTotal[k];
+	}
+	printf(" %8lu\n\n", used);
+
+	if (used > ram) {
+		printf("globals: %lu bytes - that's %lu more than there is!\n", used, used - ram);
+		return 1;
+	}
+	printf("globals: %lu bytes (%lu%%), leaving %lu bytes for the stack\n",
+		used, used * 100 / ram, ram - used);
+
+	if (nsu == 0) {
+		return 0;
+	}
+
+	qsort(Funcs, NumFuncs, sizeof(Funcs[0]), bybytes);
+	printf("\n%-32s %-20s %6s  %s\n", "function", "file", "frame", "");
+	isrmax = fnmax = 0;
+	for (i = 0; i < NumFuncs; i++) {
+		printf("%-32s %-20s %6lu  %s%s\n", Funcs[i].name, Funcs[i].file, Funcs[i].bytes,
+			(strcmp(Funcs[i].kind, "static") == 0) ? "" : Funcs[i].kind,
+			isisr(Funcs[i].name) ? " (ISR)" : "");
+		if (isisr(Funcs[i].name)) {
+			if (Funcs[i].bytes > isrmax) {
+				isrmax = Funcs[i].bytes;
+			}
+		} else if (Funcs[i].bytes > fnmax) {
+			fnmax = Funcs[i].bytes;
+		}
+	}
+
+	// (frames only - the call chains, and the return addresses on them, come on top of this)
+	printf("\nbiggest ISR frame %lu, biggest function frame %lu: the stack needs at least %lu,\n"
+		"plus the frames of everything they call.  check stack_headroom() on the real thing.\n",
+		isrmax, fnmax, isrmax + fnmax);
+	return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ *	replayc.c - replay table compiler for Mignonette (runs on the host, not the AVR!)
+ *
+ *	converts a recording of button presses (made by host/migemu -r) into a table for
+ *	setreplay(), so the Mignonette itself can replay it.
+ *	see "replaying button presses" in miggl.h for the table format.
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	usage:
+ *		replayc [-o out.h] [-n name] recording.log
+ *
+ *	the table is called Replay, unless a name is given.  the frame hashes in the recording
+ *	are left out (they are only checked on the host, by migemu -R).
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+#define MAXLINE		128
+#define MAXNAME		64
+
+static const char *FileName;
+static int LineNum;
+static const char *OutName;		// output file (removed if there is an error, so make tries again)
+
+static unsigned long Pairs;		// pairs written so far
+static unsigned long Cycles;
+static unsigned long RunCycles;	// cycles that RunMask has been held down for (not written yet)
+static unsigned RunMask;
+
+
+static void error(const char *msg, const char *arg)
+{
+	fprintf(stderr, "%s:%d: %s%s\n", FileName, LineNum, msg, (arg != NULL) ? arg : "");
+	if (OutName != NULL) {
+		remove(OutName);
+	}
+	exit(1);
+}
+
+
+//
+// write pairs for the buttons held down so far (at most 255 cycles in each pair)
+//
+static void writerun(FILE *out)
+{
+	unsigned run;
+
+	Cycles += RunCycles;
+	while (RunCycles) {
+		run = (RunCycles > 255) ? 255 : RunCycles;
+		fprintf(out, "%s%3u,0x%x,", (Pairs % 8) ? "  " : "\n\t", run, RunMask);
+		Pairs++;
+		RunCycles -= run;
+	}
+}
+
+
+//
+// mask was held down for n cycles (lines that only change the frame hash are merged)
+//
+static void addrun(FILE *out, unsigned long n, unsigned mask)
+{
+	if (mask != RunMask) {
+		writerun(out);
+		RunMask = mask;
+	}
+	RunCycles += n;
+}
+
+
+int main(int argc, char **argv)
+{
+	char line[MAXLINE];
+	const char *name;
+	unsigned long cycle, prev, end;
+	unsigned mask, prevmask, hash;
+	FILE *in, *out;
+	int i, havefirst;
+
+	OutName = NULL;
+	FileName = NULL;
+	name = "Replay";
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-o") == 0) && (i+1 < argc)) {
+			OutName = argv[++i];
+		} else if ((strcmp(argv[i], "-n") == 0) && (i+1 < argc)) {
+			name = argv[++i];
+		} else if (FileName == NULL) {
+			FileName = argv[i];
+		} else {
+			FileName = NULL;
+			break;
+		}
+	}
+	if ((FileName == NULL) || (strlen(name) >= MAXNAME)
+		|| !(isalpha((unsigned char)name[0]) || (name[0] == '_'))) {
+		fprintf(stderr, "usage: replayc [-o out.h] [-n name] recording.log\n");
+		return 1;
+	}
+
+	in = fopen(FileName, "r");
+	if (in == NULL) {
+		perror(FileName);
+		return 1;
+	}
+	out = stdout;
+	if (OutName != NULL) {
+		out = fopen(OutName, "w");
+		if (out == NULL) {
+			perror(OutName);
+			return 1;
+		}
+	}
+	fprintf(out, "/*\n *\t%s - replay table, made by tools/replayc from %s - don't edit!\n */\n",
+		(OutName != NULL) ? OutName : "(stdout)", FileName);
+	fprintf(out, "\nconst byte %s[] PROGMEM = {", name);
+
+	havefirst = 0;
+	prev = end = 0;
+	prevmask = 0;
+	LineNum = 0;
+	while (fgets(line, sizeof(line), in) != NULL) {
+		LineNum++;
+		if ((line[0] == '#') || (line[strspn(line, " \t\r\n")] == '\0')) {
+			continue;
+		}
+		if (sscanf(line, "end %lu", &end) == 1) {
+			break;
+		}
+		if (sscanf(line, "%lu %x %x", &cycle, &mask, &hash) != 3) {
+			error("bad line: ", line);
+		}
+		if (mask > 0xf) {
+			error("bad button mask: ", line);
+		}
+		if (!havefirst) {
+			if (cycle != 0) {
+				error("the first line must be for cycle 0", NULL);
+			}
+			havefirst = 1;
+		} else {
+			if (cycle <= prev) {
+				error("cycles must go up: ", line);
+			}
+			addrun(out, cycle - prev, prevmask);
+		}
+		prev = cycle;
+		prevmask = mask;
+	}
+	fclose(in);
+	if (!havefirst || (end <= prev)) {
+		error("no \"end\" line (or it is too early)", NULL);
+	}
+	addrun(out, end - prev, prevmask);
+	writerun(out);
+
+	fprintf(out, "\n\t0,0\n};\n// %lu display cycles (%.2f sec), %lu bytes\n",
+		Cycles, Cycles / 100.0, (Pairs + 1) * 2);
+	if (out != stdout) {
+		fclose(out);
+	}
+	return 0;
+}
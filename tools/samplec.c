@@ -0,0 +1,309 @@
+/*
+ *	samplec.c - sample compiler for Mignonette (runs on the host, not the AVR!)
+ *
+ *	converts a WAV file into a sample (PROGMEM arrays) for playsample().
+ *	see struct sample in miggl.h for the formats.
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	usage:
+ *		samplec [-o out.h] [-n name] [-r rate] [-p] sound.wav
+ *
+ *	the WAV file can be 8 or 16 bit PCM, mono or stereo (the channels are mixed), at any rate.
+ *	it is resampled to rate (8000 unless given), and written as 4 bit DPCM, or 8 bit PCM with -p.
+ *	DPCM takes half the flash, but can't follow very fast changes (see DPCM_STEPS).
+ *
+ *	the output has:
+ *		const byte BoomData[] PROGMEM		the samples
+ *		const struct sample Boom			for playsample()
+ *
+ *	where the name (Boom here) is the file name, capitalized, unless given.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "../mydefs.h"
+#include "../miggl.h"
+#include "../miggl-private.h"
+
+
+#define MAXNAME		64
+#define MAXSAMPLES	65535		// (length is 16 bits, and there is only 16k of flash anyway)
+
+static const char *FileName;
+static const int DpcmStep[16] = { DPCM_STEPS };
+
+static double *In;				// input samples (-1 to 1)
+static long NumIn;
+static long InRate;
+
+
+static void error(const char *msg)
+{
+	fprintf(stderr, "%s: %s\n", FileName, msg);
+	exit(1);
+}
+
+
+static unsigned long get16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned long get32(const unsigned char *p)
+{
+	return get16(p) | (get16(p+2) << 16);
+}
+
+
+//
+// read a WAV file into In[], mixing the channels
+//
+static void readwav(FILE *f)
+{
+	unsigned char hdr[12], chunk[8], fmt[16];
+	unsigned char *data;
+	unsigned long size, i;
+	int channels, bits, havefmt, c, bytes;
+	double v;
+
+	if ((fread(hdr, 1, 12, f) != 12) || (memcmp(hdr, "RIFF", 4) != 0) || (memcmp(hdr+8, "WAVE", 4) != 0)) {
+		error("not a WAV file");
+	}
+	havefmt = 0;
+	channels = bits = 0;
+	while (fread(chunk, 1, 8, f) == 8) {
+		size = get32(chunk+4);
+		if (memcmp(chunk, "fmt ", 4) == 0) {
+			if ((size < 16) || (fread(fmt, 1, 16, f) != 16)) {
+				error("bad fmt chunk");
+			}
+			if (get16(fmt) != 1) {
+				error("not PCM (only plain 8 or 16 bit PCM is read)");
+			}
+			channels = get16(fmt+2);
+			InRate = get32(fmt+4);
+			bits = get16(fmt+14);
+			if ((channels < 1) || (InRate == 0) || ((bits != 8) && (bits != 16))) {
+				error("only 8 or 16 bit PCM is read");
+			}
+			havefmt = 1;
+			fseek(f, (size - 16) + (size & 1), SEEK_CUR);
+		} else if (memcmp(chunk, "data", 4) == 0) {
+			if (!havefmt) {
+				error("data before fmt");
+			}
+			data = malloc(size);
+			if ((data == NULL) || (fread(data, 1, size, f) != size)) {
+				error("short data chunk");
+			}
+			bytes = bits / 8;
+			NumIn = size / (bytes * channels);
+			In = malloc((NumIn + 1) * sizeof(In[0]));
+			if (In == NULL) {
+				error("out of memory");
+			}
+			for (i = 0; i < (unsigned long)NumIn; i++) {
+				v = 0;
+				for (c = 0; c < channels; c++) {
+					if (bits == 8) {
+						v += (data[(i*channels + c)] - 128) / 128.0;
+					} else {
+						v += (int16_t)get16(&data[(i*channels + c) * 2]) / 32768.0;
+					}
+				}
+				In[i] = v / channels;
+			}
+			free(data);
+			return;
+		} else {
+			fseek(f, size + (size & 1), SEEK_CUR);
+		}
+	}
+	error("no data chunk");
+}
+
+
+//
+// resample In[] to rate, as values from 0 to 255.  each output sample is the average of the
+// input samples it covers (or the nearest one, when going up in rate).
+//
+static unsigned char *resample(long rate, long *n)
+{
+	unsigned char *out;
+	double step, pos, sum, v;
+	long i, j, a, b;
+
+	step = (double)InRate / rate;
+	*n = (long)(NumIn / step);
+	if (*n > MAXSAMPLES) {
+		error("too long (more than 65535 samples at this rate)");
+	}
+	if (*n == 0) {
+		error("no samples");
+	}
+	out = malloc(*n);
+	if (out == NULL) {
+		error("out of memory");
+	}
+	for (i = 0; i < *n; i++) {
+		pos = i * step;
+		a = (long)pos;
+		b = (long)(pos + step);
+		if (b <= a) {
+			b = a + 1;
+		}
+		if (b > NumIn) {
+			b = NumIn;
+		}
+		sum = 0;
+		for (j = a; j < b; j++) {
+			sum += In[j];
+		}
+		v = sum / (b - a) * 128.0 + 128.0;
+		out[i] = (v < 0) ? 0 : (v > 255) ? 255 : (unsigned char)(v + 0.5);
+	}
+	return out;
+}
+
+
+//
+// pick the DPCM step (see DPCM_STEPS) that lands closest to each sample, from where the
+// decoder will really be (so errors don't add up).  steps that would go past 0 or 255 are
+// never picked, since the decoder doesn't check.
+//
+static int dpcm(const unsigned char *s, long n, unsigned char *out)
+{
+	int val, best, k, err, besterr, next;
+	long i;
+
+	val = 128;
+	memset(out, 0, (n + 1) / 2);
+	for (i = 0; i < n; i++) {
+		best = 8;				// (step 0)
+		besterr = 1000;
+		for (k = 0; k < 16; k++) {
+			next = val + DpcmStep[k];
+			if ((next < 0) || (next > 255)) {
+				continue;
+			}
+			err = abs(next - s[i]);
+			if (err < besterr) {
+				besterr = err;
+				best = k;
+			}
+		}
+		val += DpcmStep[best];
+		out[i/2] |= (i & 1) ? (best << 4) : best;
+	}
+	return (n + 1) / 2;
+}
+
+
+int main(int argc, char **argv)
+{
+	char name[MAXNAME];
+	const char *outname, *p, *fmt;
+	unsigned char *smp, *data;
+	long rate, n, nbytes, i;
+	int pcm;
+	FILE *in, *out;
+
+	outname = NULL;
+	FileName = NULL;
+	name[0] = '\0';
+	rate = 8000;
+	pcm = 0;
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-o") == 0) && (i+1 < argc)) {
+			outname = argv[++i];
+		} else if ((strcmp(argv[i], "-n") == 0) && (i+1 < argc) && (strlen(argv[i+1]) < MAXNAME)) {
+			strcpy(name, argv[++i]);
+		} else if ((strcmp(argv[i], "-r") == 0) && (i+1 < argc)) {
+			rate = strtol(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-p") == 0) {
+			pcm = 1;
+		} else if (FileName == NULL) {
+			FileName = argv[i];
+		} else {
+			FileName = NULL;
+			break;
+		}
+	}
+	if ((FileName == NULL) || (rate <= 0) || (rate > 65535)) {
+		fprintf(stderr, "usage: samplec [-o out.h] [-n name] [-r rate] [-p] sound.wav\n");
+		return 1;
+	}
+
+	// the name is the file name (without directory or extension), capitalized
+	if (name[0] == '\0') {
+		p = strrchr(FileName, '/');
+		p = (p != NULL) ? p+1 : FileName;
+		for (i = 0; p[i] && (p[i] != '.') && (i < MAXNAME-1); i++) {
+			name[i] = isalnum((unsigned char)p[i]) ? p[i] : '_';
+		}
+		name[i] = '\0';
+		name[0] = toupper((unsigned char)name[0]);
+	}
+	if (!(isalpha((unsigned char)name[0]) || (name[0] == '_'))) {
+		fprintf(stderr, "samplec: bad name \"%s\" (use -n)\n", name);
+		return 1;
+	}
+
+	in = fopen(FileName, "rb");
+	if (in == NULL) {
+		perror(FileName);
+		return 1;
+	}
+	readwav(in);
+	fclose(in);
+
+	smp = resample(rate, &n);
+	if (pcm) {
+		data = smp;
+		nbytes = n;
+	} else {
+		data = malloc((n + 1) / 2);
+		if (data == NULL) {
+			error("out of memory");
+		}
+		nbytes = dpcm(smp, n, data);
+	}
+
+	out = stdout;
+	if (outname != NULL) {
+		out = fopen(outname, "w");
+		if (out == NULL) {
+			perror(outname);
+			return 1;
+		}
+	}
+	fprintf(out, "/*\n *\t%s - sample, made by tools/samplec from %s - don't edit!\n */\n",
+		(outname != NULL) ? outname : "(stdout)", FileName);
+	fprintf(out, "\n// %ld samples (%.2f sec at %ld Hz), %s, %ld bytes\n",
+		n, (double)n / rate, rate, pcm ? "8 bit PCM" : "4 bit DPCM", nbytes);
+	fprintf(out, "const byte %sData[] PROGMEM = {", name);
+	for (i = 0; i < nbytes; i++) {
+		fprintf(out, "%s0x%02x,", (i % 12) ? " " : "\n\t", data[i]);
+	}
+	fprintf(out, "\n};\n");
+	fmt = pcm ? "SAMPLE_PCM8" : "SAMPLE_DPCM4";
+	fprintf(out, "const struct sample %s = { %sData, %ld, %ld, %s };\n", name, name, n, rate, fmt);
+	if (out != stdout) {
+		fclose(out);
+	}
+	return 0;
+}
@@ -0,0 +1,507 @@
+/*
+ *	songc.c - song compiler for Mignonette (runs on the host, not the AVR!)
+ *
+ *	compiles songs written as MML or RTTTL text into packed song data (PROGMEM arrays),
+ *	for playpackedsong().  see PACK_DURS in miggl-private.h for the packed format.
+ *
+ *	Note: This source code is licensed under a Creative Commons License, CC-by-nc-sa.
+ *		(attribution, non-commercial, share-alike)
+ *  	see http://creativecommons.org/licenses/by-nc-sa/3.0/ for details.
+ *
+ *	usage:
+ *		songc [-o out.h] songs.txt
+ *
+ *	each line of the input is one song, either MML:
+ *
+ *		name: t120 l8 o4 c d e f g4 r c<b>c2
+ *
+ *	or RTTTL (as used for ringtones):
+ *
+ *		name:d=4,o=5,b=120:8c,8d,8e,f,g.,2p,c6
+ *
+ *	blank lines, and lines starting with #, are ignored.
+ *	each song becomes "const byte name[] PROGMEM = {...};" in the output.
+ *
+ *	MML commands (upper or lower case, spaces are ignored):
+ *		c d e f g a b	note, with optional +, # (sharp) or - (flat), length and dots, e.g. c+8.
+ *		r or p			rest, with optional length and dots
+ *		&				tie (add the next note's length to this one)
+ *		o n				octave (o4 is middle C)
+ *		< >				octave down, up
+ *		l n				default length (l4 is a quarter note), dots are allowed
+ *		t n				tempo in quarter notes per minute (up to 255)
+ *
+ *	lengths are 1 (whole note), 2, 4, 8, 16, etc.  triplets are 3, 6, 12, 24.
+ *	notes must be in the range C3 to C6.  RTTTL songs (which are usually higher) are moved
+ *	down by octaves to fit, if they can be.
+ *
+ *	revision history:
+ *
+ *	- oct 19, 2026
+ *		created.
+ *
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "../mydefs.h"
+#include "../miggl.h"
+#include "../miggl-private.h"
+
+
+#define MAXEVENTS	2000
+#define MAXLINE		4096
+
+#define EV_TEMPO	S_TEMPO		// (an event that isn't a note or rest)
+
+struct event {
+	int note;		// MIN_NOTE to MAX_NOTE, N_REST or EV_TEMPO
+	int dur;		// units (1/48 of a whole note), or tempo for EV_TEMPO
+};
+
+static struct event Events[MAXEVENTS];
+static int NumEvents;
+
+static const uint8_t PackDur[] = { PACK_DURS };
+
+static const char *FileName;
+static int LineNum;
+static const char *OutName;		// output file (removed if there is an error, so make tries again)
+
+
+static void error(const char *msg, const char *arg)
+{
+	fprintf(stderr, "%s:%d: %s%s\n", FileName, LineNum, msg, (arg != NULL) ? arg : "");
+	if (OutName != NULL) {
+		remove(OutName);
+	}
+	exit(1);
+}
+
+
+static void addevent(int note, int dur)
+{
+	if (NumEvents >= MAXEVENTS) {
+		error("song too long", NULL);
+	}
+	Events[NumEvents].note = note;
+	Events[NumEvents].dur = dur;
+	NumEvents++;
+}
+
+
+//
+// a tempo change (tempos are a byte in the song, so faster ones are held to 255)
+//
+static void addtempo(int bpm)
+{
+	if (bpm > 255) {
+		fprintf(stderr, "%s:%d: warning: tempo %d is too fast, using 255\n", FileName, LineNum, bpm);
+		bpm = 255;
+	}
+	addevent(EV_TEMPO, bpm);
+}
+
+
+//
+// convert a length (1 for a whole note, 4 for a quarter, etc) into units, rounded.
+//
+static int lentounits(int len)
+{
+	int units;
+
+	if (len <= 0) {
+		error("bad length", NULL);
+	}
+	units = (48 + len/2) / len;
+	return (units > 0) ? units : 1;
+}
+
+
+//
+// add dots to a duration (each dot adds half of what the last one added).
+//
+static int adddots(const char **sp, int units)
+{
+	int add;
+
+	add = units;
+	while (**sp == '.') {
+		add /= 2;
+		units += add;
+		(*sp)++;
+	}
+	return units;
+}
+
+
+static int readnum(const char **sp, int def)
+{
+	int n;
+
+	if (!isdigit((unsigned char)**sp)) {
+		return def;
+	}
+	n = 0;
+	while (isdigit((unsigned char)**sp)) {
+		n = n*10 + (**sp - '0');
+		(*sp)++;
+	}
+	return n;
+}
+
+
+// half steps above C for each letter a to g
+static const int Semi[7] = { 9, 11, 0, 2, 4, 5, 7 };
+
+static int notevalue(int letter, int octave, int accidental)
+{
+	return N_C3 + (octave - 3)*12 + Semi[letter - 'a'] + accidental;
+}
+
+
+static void skipspace(const char **sp)
+{
+	while (isspace((unsigned char)**sp)) {
+		(*sp)++;
+	}
+}
+
+
+//
+// parse the notes of a MML song
+//
+static void parsemml(const char *s)
+{
+	int octave, deflen, c, note, acc, units, tie;
+
+	octave = 4;
+	deflen = lentounits(4);
+	tie = 0;
+
+	for (;;) {
+		skipspace(&s);
+		c = tolower((unsigned char)*s);
+		if (c == '\0') {
+			break;
+		}
+		s++;
+		skipspace(&s);
+
+		if ((c >= 'a') && (c <= 'g')) {
+			acc = 0;
+			while ((*s == '+') || (*s == '#') || (*s == '-')) {
+				acc += (*s == '-') ? -1 : 1;
+				s++;
+			}
+			note = notevalue(c, octave, acc);
+			if ((note < MIN_NOTE) || (note > MAX_NOTE)) {
+				error("note out of range (C3 to C6)", NULL);
+			}
+			units = readnum(&s, 0);
+			units = (units != 0) ? lentounits(units) : deflen;
+			units = adddots(&s, units);
+		} else if ((c == 'r') || (c == 'p')) {
+			note = N_REST;
+			units = readnum(&s, 0);
+			units = (units != 0) ? lentounits(units) : deflen;
+			units = adddots(&s, units);
+		} else if (c == '&') {
+			tie = 1;
+			continue;
+		} else if (c == 'o') {
+			octave = readnum(&s, 4);
+			continue;
+		} else if (c == '<') {
+			octave--;
+			continue;
+		} else if (c == '>') {
+			octave++;
+			continue;
+		} else if (c == 'l') {
+			deflen = adddots(&s, lentounits(readnum(&s, 4)));
+			continue;
+		} else if (c == 't') {
+			addtempo(readnum(&s, DEFAULTTEMPO));
+			continue;
+		} else {
+			char bad[2] = { (char)c, '\0' };
+			error("unknown MML command: ", bad);
+		}
+
+		if (tie) {
+			if ((NumEvents == 0) || (Events[NumEvents-1].note == EV_TEMPO)) {
+				error("nothing to tie to", NULL);
+			}
+			Events[NumEvents-1].dur += units;
+			tie = 0;
+		} else {
+			addevent(note, units);
+		}
+	}
+}
+
+
+//
+// parse a RTTTL song (everything after the name)
+//
+static void parsertttl(const char *s)
+{
+	int defdur, defoct, bpm, c, len, units, octave, acc, note;
+	int lo, hi, shift, i;
+	const char *p;
+
+	// defaults section, up to the next colon
+	defdur = 4;
+	defoct = 6;
+	bpm = 63;
+	while (*s && (*s != ':')) {
+		skipspace(&s);
+		c = tolower((unsigned char)*s);
+		if ((c != '\0') && (c != ':') && (s[1] == '=')) {
+			s += 2;
+			if (c == 'd') {
+				defdur = readnum(&s, 4);
+			} else if (c == 'o') {
+				defoct = readnum(&s, 6);
+			} else if (c == 'b') {
+				bpm = readnum(&s, 63);
+			}
+		}
+		while (*s && (*s != ',') && (*s != ':')) {
+			s++;
+		}
+		if (*s == ',') {
+			s++;
+		}
+	}
+	if (*s != ':') {
+		error("bad RTTTL (no notes section)", NULL);
+	}
+	s++;
+
+	addtempo(bpm);
+
+	// notes, separated by commas: [length]note[#][.][octave][.]
+	lo = 255;
+	hi = 0;
+	for (p = s; *p; ) {
+		skipspace(&p);
+		if (*p == '\0') {
+			break;
+		}
+		len = readnum(&p, defdur);
+		c = tolower((unsigned char)*p);
+		if (c == 'h') {					// (some ringtones use h for b)
+			c = 'b';
+		}
+		if (!(((c >= 'a') && (c <= 'g')) || (c == 'p'))) {
+			error("bad RTTTL note: ", p);
+		}
+		p++;
+		acc = 0;
+		if (*p == '#') {
+			acc = 1;
+			p++;
+		}
+		units = adddots(&p, lentounits(len));
+		octave = readnum(&p, defoct);
+		units = adddots(&p, units);
+		skipspace(&p);
+		if (*p == ',') {
+			p++;
+		} else if (*p != '\0') {
+			error("bad RTTTL note: ", p);
+		}
+
+		if (c == 'p') {
+			addevent(N_REST, units);
+		} else {
+			note = notevalue(c, octave, acc);
+			if (note < lo) {
+				lo = note;
+			}
+			if (note > hi) {
+				hi = note;
+			}
+			addevent(note, units);
+		}
+	}
+
+	// move the song by octaves to fit our range
+	if (lo > hi) {
+		return;
+	}
+	if (hi - lo > MAX_NOTE - MIN_NOTE) {
+		error("song spans too many notes (C3 to C6 only)", NULL);
+	}
+	shift = 0;
+	while (hi + shift > MAX_NOTE) {
+		shift -= 12;
+	}
+	while (lo + shift < MIN_NOTE) {
+		shift += 12;
+	}
+	if (hi + shift > MAX_NOTE) {
+		error("song doesn't fit in C3 to C6", NULL);
+	}
+	if (shift) {
+		fprintf(stderr, "%s:%d: moved %d octave(s) to fit\n", FileName, LineNum, shift / 12);
+		for (i = 0; i < NumEvents; i++) {
+			if ((Events[i].note != N_REST) && (Events[i].note != EV_TEMPO)) {
+				Events[i].note += shift;
+			}
+		}
+	}
+}
+
+
+//
+// pack the events and write them out as a PROGMEM array
+//
+static void writesong(FILE *out, const char *name)
+{
+	uint8_t buf[MAXEVENTS*3 + 2];
+	int n, i, d, delta, prev, nnotes, ntable;
+	struct event *e;
+
+	n = 0;
+	prev = PACK_FIRSTNOTE;
+	nnotes = 0;
+	ntable = 1;			// (size as a song table, with N_END)
+	for (i = 0; i < NumEvents; i++) {
+		e = &Events[i];
+		if (e->note == EV_TEMPO) {
+			buf[n++] = PACK_ESCAPE;
+			buf[n++] = S_TEMPO;
+			buf[n++] = (e->dur < (int)MINTEMPO) ? (int)MINTEMPO : e->dur;
+			ntable += 2;
+			continue;
+		}
+		if (e->dur > 255) {
+			error("note too long in song ", name);
+		}
+
+		for (d = 0; d < PACK_LITERAL; d++) {
+			if (PackDur[d] == e->dur) {
+				break;
+			}
+		}
+
+		if (e->note == N_REST) {
+			buf[n++] = (d << PACK_DURSHIFT) | PACK_REST;
+		} else {
+			delta = e->note - prev;
+			if ((delta >= -PACK_DELTA0) && (delta + PACK_DELTA0 < PACK_REST)) {
+				buf[n++] = (d << PACK_DURSHIFT) | (delta + PACK_DELTA0);
+			} else {
+				buf[n++] = (d << PACK_DURSHIFT) | PACK_ESCAPE;
+				buf[n++] = e->note;
+			}
+			prev = e->note;
+		}
+		if (d == PACK_LITERAL) {
+			buf[n++] = e->dur;
+		}
+		nnotes++;
+		ntable += 2;
+	}
+	buf[n++] = PACK_ESCAPE;
+	buf[n++] = N_END;
+
+	fprintf(out, "\n// %s: %d notes, %d bytes (%d as a song table)\n", name, nnotes, n, ntable);
+	fprintf(out, "const byte %s[] PROGMEM = {", name);
+	for (i = 0; i < n; i++) {
+		fprintf(out, "%s0x%02x,", (i % 12) ? " " : "\n\t", buf[i]);
+	}
+	fprintf(out, "\n};\n");
+}
+
+
+int main(int argc, char **argv)
+{
+	char line[MAXLINE];
+	char name[MAXLINE];
+	const char *s;
+	char *colon;
+	FILE *in, *out;
+	int i;
+
+	OutName = NULL;
+	FileName = NULL;
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-o") == 0) && (i+1 < argc)) {
+			OutName = argv[++i];
+		} else if (FileName == NULL) {
+			FileName = argv[i];
+		} else {
+			FileName = NULL;
+			break;
+		}
+	}
+	if (FileName == NULL) {
+		fprintf(stderr, "usage: songc [-o out.h] songs.txt\n");
+		return 1;
+	}
+
+	in = fopen(FileName, "r");
+	if (in == NULL) {
+		perror(FileName);
+		return 1;
+	}
+	out = stdout;
+	if (OutName != NULL) {
+		out = fopen(OutName, "w");
+		if (out == NULL) {
+			perror(OutName);
+			return 1;
+		}
+	}
+
+	fprintf(out, "/*\n *\t%s - packed songs, made by tools/songc from %s - don't edit!\n */\n",
+		(OutName != NULL) ? OutName : "(stdout)", FileName);
+
+	LineNum = 0;
+	while (fgets(line, sizeof(line), in) != NULL) {
+		LineNum++;
+		line[strcspn(line, "\r\n")] = '\0';
+		s = line;
+		skipspace(&s);
+		if ((*s == '\0') || (*s == '#')) {
+			continue;
+		}
+
+		colon = strchr(s, ':');
+		if (colon == NULL) {
+			error("expected \"name: notes\"", NULL);
+		}
+		i = 0;
+		while ((s < colon) && (isalnum((unsigned char)*s) || (*s == '_'))) {
+			name[i++] = *s++;
+		}
+		name[i] = '\0';
+		skipspace(&s);
+		if ((i == 0) || (s != colon) || isdigit((unsigned char)name[0])) {
+			error("bad song name", NULL);
+		}
+
+		NumEvents = 0;
+		if (strchr(colon+1, ':') != NULL) {
+			parsertttl(colon+1);
+		} else {
+			parsemml(colon+1);
+		}
+		writesong(out, name);
+	}
+
+	fclose(in);
+	if (out != stdout) {
+		fclose(out);
+	}
+	return 0;
+}
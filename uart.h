@@ -1,42 +1,42 @@
-/*
- * ----------------------------------------------------------------------------
- * "THE BEER-WARE LICENSE" (Revision 42):
- * <joerg@FreeBSD.ORG> wrote this file.  As long as you retain this notice you
- * can do whatever you want with this stuff. If we meet some day, and you think
- * this stuff is worth it, you can buy me a beer in return.        Joerg Wunsch
- * ----------------------------------------------------------------------------
- *
- * Stdio demo, UART declarations
- *
- * $Id: uart.h,v 1.1.2.1 2005/12/28 22:35:08 joerg_wunsch Exp $
- */
-
-/* CPU frequency */
-//#define F_CPU 16000000UL
-#define F_CPU 8000000UL
-//#define F_CPU 1000000UL
-
-/* UART baud rate */
-#define UART_BAUD  9600
-
-/*
- * Perform UART startup initialization.
- */
-void	uart_init(void);
-
-/*
- * Send one character to the UART.
- */
-int	uart_putchar(char c, FILE *stream);
-
-/*
- * Size of internal line buffer used by uart_getchar().
- */
-#define RX_BUFSIZE 80
-
-/*
- * Receive one character from the UART.  The actual reception is
- * line-buffered, and one character is returned from the buffer at
- * each invokation.
- */
-int	uart_getchar(FILE *stream);
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <joerg@FreeBSD.ORG> wrote this file.  As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return.        Joerg Wunsch
+ * ----------------------------------------------------------------------------
+ *
+ * Stdio demo, UART declarations
+ *
+ * $Id: uart.h,v 1.1.2.1 2005/12/28 22:35:08 joerg_wunsch Exp $
+ */
+
+/* CPU frequency (the Makefile passes it in, see F_CPU there) */
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/* UART baud rate */
+#define UART_BAUD  9600
+
+/*
+ * Perform UART startup initialization.
+ */
+void	uart_init(void);
+
+/*
+ * Send one character to the UART.
+ */
+int	uart_putchar(char c, FILE *stream);
+
+/*
+ * Size of internal line buffer used by uart_getchar().
+ */
+#define RX_BUFSIZE 80
+
+/*
+ * Receive one character from the UART.  The actual reception is
+ * line-buffered, and one character is returned from the buffer at
+ * each invokation.
+ */
+int	uart_getchar(FILE *stream);